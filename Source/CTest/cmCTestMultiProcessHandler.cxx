@@ -7,14 +7,18 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef> // IWYU pragma: keep
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <functional>
 #include <list>
+#include <queue>
 #include <sstream>
 #include <stack>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -45,6 +49,55 @@ namespace cmsys {
 class RegularExpression;
 }
 
+namespace {
+// One line of the cost data file:
+//   <name> <previous_runs> <avg_cost> [<cost_variance> [<peak_memory>]]
+// The trailing fields are optional so that files written by older
+// versions can still be read.  The peak memory is in KiB.
+struct CostEntry
+{
+  std::string Name;
+  int PreviousRuns = 0;
+  float Cost = 0;
+  float Variance = 0;
+  uint64_t PeakMemory = 0;
+};
+
+bool ParseCostEntry(std::string const& line, CostEntry& entry)
+{
+  std::string::size_type const end = line.find(' ');
+  if (end == std::string::npos || end == 0) {
+    return false;
+  }
+  entry.Name.assign(line, 0, end);
+
+  char const* p = line.c_str() + end;
+  char* next = nullptr;
+  entry.PreviousRuns = static_cast<int>(std::strtol(p, &next, 10));
+  if (next == p) {
+    return false;
+  }
+  p = next;
+  entry.Cost = std::strtof(p, &next);
+  if (next == p) {
+    return false;
+  }
+  p = next;
+  entry.Variance = std::strtof(p, &next);
+  if (next == p) {
+    entry.Variance = 0;
+    entry.PeakMemory = 0;
+    return true;
+  }
+  p = next;
+  entry.PeakMemory = std::strtoull(p, &next, 10);
+  if (next == p) {
+    entry.PeakMemory = 0;
+  }
+  return true;
+}
+}
+
 class TestComparator
 {
 public:
@@ -86,6 +139,12 @@ void cmCTestMultiProcessHandler::SetTests(TestMap& tests,
   this->Tests = tests;
   this->Properties = properties;
   this->Total = this->Tests.size();
+  this->TestsByName.clear();
+  this->TestsByName.reserve(this->Properties.size());
+  for (auto const& p : this->Properties) {
+    // Keep the last index for duplicate names, as a linear search would
+    this->TestsByName[p.second->Name] = p.first;
+  }
   // set test run map to false for all
   for (auto const& t : this->Tests) {
     this->TestRunningMap[t.first] = false;
@@ -132,11 +191,25 @@ void cmCTestMultiProcessHandler::RunTests()
 #endif
   this->TestHandler->SetMaxIndex(this->FindMaxIndex());
 
+  auto const startTime = std::chrono::steady_clock::now();
   uv_loop_init(&this->Loop);
   this->StartNextTests();
   uv_run(&this->Loop, UV_RUN_DEFAULT);
   uv_loop_close(&this->Loop);
 
+  if (this->PredictedMakespan > cmDuration::zero()) {
+    cmDuration const actual = std::chrono::steady_clock::now() - startTime;
+    char buf[128];
+    snprintf(buf, sizeof(buf),
+             "%6.2f sec, actual makespan %6.2f sec "
+             "(critical path %6.2f sec)",
+             this->PredictedMakespan.count(), actual.count(),
+             this->CriticalPathLength.count());
+    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                       "\nPredicted makespan " << buf << std::endl,
+                       this->Quiet);
+  }
+
   if (!this->StopTimePassed && !this->CheckStopOnFailure()) {
     assert(this->Completed == this->Total);
     assert(this->Tests.empty());
@@ -170,6 +243,11 @@ bool cmCTestMultiProcessHandler::StartTestProcess(int test)
   // now remove the test itself
   this->EraseTest(test);
   this->RunningCount += this->GetProcessorsUsed(test);
+  if (this->MemoryBudget > 0) {
+    uint64_t const memory = this->GetMemoryEstimate(test);
+    this->ReservedMemory[test] = memory;
+    this->MemoryInUse += memory;
+  }
 
   auto testRun = cm::make_unique<cmCTestRunTest>(*this);
 
@@ -551,6 +629,13 @@ void cmCTestMultiProcessHandler::StartNextTests()
     if (this->Properties[test]->RunSerial && this->RunningCount > 0) {
       continue;
     }
+    // Hold back tests that would exceed the memory budget.  A test is
+    // always admitted when nothing else runs so that it cannot starve.
+    if (this->MemoryBudget > 0 && this->RunningCount > 0 &&
+        this->MemoryInUse + this->GetMemoryEstimate(test) >
+          this->MemoryBudget) {
+      continue;
+    }
 
     size_t processors = this->GetProcessorsUsed(test);
     bool testLoadOk = true;
@@ -661,6 +746,11 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
   this->DeallocateResources(test);
   this->UnlockResources(test);
   this->RunningCount -= this->GetProcessorsUsed(test);
+  auto reserved = this->ReservedMemory.find(test);
+  if (reserved != this->ReservedMemory.end()) {
+    this->MemoryInUse -= reserved->second;
+    this->ReservedMemory.erase(reserved);
+  }
 
   for (auto p : properties->Affinity) {
     this->ProcessorsAvailable.insert(p);
@@ -673,6 +763,31 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
   }
 }
 
+void cmCTestMultiProcessHandler::WriteCostEntry(std::ostream& os,
+                                                std::string const& name,
+                                                int prev, float cost,
+                                                float variance,
+                                                uint64_t peakMemory)
+{
+  os << name << " " << prev << " " << cost;
+  if (variance > 0 || peakMemory > 0) {
+    os << " " << variance;
+  }
+  if (peakMemory > 0) {
+    os << " " << peakMemory;
+  }
+  os << "\n";
+}
+
+uint64_t cmCTestMultiProcessHandler::GetMemoryEstimate(int index) const
+{
+  auto i = this->Properties.find(index);
+  if (i != this->Properties.end() && i->second->PeakMemory > 0) {
+    return i->second->PeakMemory;
+  }
+  return this->DefaultMemoryEstimate;
+}
+
 void cmCTestMultiProcessHandler::UpdateCostData()
 {
   std::string fname = this->CTest->GetCostDataFile();
@@ -680,36 +795,33 @@ void cmCTestMultiProcessHandler::UpdateCostData()
   cmsys::ofstream fout;
   fout.open(tmpout.c_str());
 
-  PropertiesMap temp = this->Properties;
+  std::unordered_set<int> written;
+  written.reserve(this->Properties.size());
 
   if (cmSystemTools::FileExists(fname)) {
     cmsys::ifstream fin;
     fin.open(fname.c_str());
 
     std::string line;
+    CostEntry entry;
     while (std::getline(fin, line)) {
       if (line == "---") {
         break;
       }
-      std::vector<std::string> parts = cmSystemTools::SplitString(line, ' ');
-      // Format: <name> <previous_runs> <avg_cost>
-      if (parts.size() < 3) {
+      if (!ParseCostEntry(line, entry)) {
         break;
       }
 
-      std::string name = parts[0];
-      int prev = atoi(parts[1].c_str());
-      float cost = static_cast<float>(atof(parts[2].c_str()));
-
-      int index = this->SearchByName(name);
+      int index = this->SearchByName(entry.Name);
       if (index == -1) {
         // This test is not in memory. We just rewrite the entry
-        fout << name << " " << prev << " " << cost << "\n";
-      } else {
+        WriteCostEntry(fout, entry.Name, entry.PreviousRuns, entry.Cost,
+                       entry.Variance, entry.PeakMemory);
+      } else if (written.insert(index).second) {
         // Update with our new average cost
-        fout << name << " " << this->Properties[index]->PreviousRuns << " "
-             << this->Properties[index]->Cost << "\n";
-        temp.erase(index);
+        auto const* p = this->Properties[index];
+        WriteCostEntry(fout, entry.Name, p->PreviousRuns, p->AverageCost,
+                       p->CostVariance, p->PeakMemory);
       }
     }
     fin.close();
@@ -717,9 +829,12 @@ void cmCTestMultiProcessHandler::UpdateCostData()
   }
 
   // Add all tests not previously listed in the file
-  for (auto const& i : temp) {
-    fout << i.second->Name << " " << i.second->PreviousRuns << " "
-         << i.second->Cost << "\n";
+  for (auto const& i : this->Properties) {
+    if (!cm::contains(written, i.first)) {
+      WriteCostEntry(fout, i.second->Name, i.second->PreviousRuns,
+                     i.second->AverageCost, i.second->CostVariance,
+                     i.second->PeakMemory);
+    }
   }
 
   // Write list of failed tests
@@ -739,60 +854,100 @@ void cmCTestMultiProcessHandler::ReadCostData()
     cmsys::ifstream fin;
     fin.open(fname.c_str());
     std::string line;
+    CostEntry entry;
     while (std::getline(fin, line)) {
       if (line == "---") {
         break;
       }
 
-      std::vector<std::string> parts = cmSystemTools::SplitString(line, ' ');
-
       // Probably an older version of the file, will be fixed next run
-      if (parts.size() < 3) {
+      if (!ParseCostEntry(line, entry)) {
         fin.close();
         return;
       }
 
-      std::string name = parts[0];
-      int prev = atoi(parts[1].c_str());
-      float cost = static_cast<float>(atof(parts[2].c_str()));
-
-      int index = this->SearchByName(name);
+      int index = this->SearchByName(entry.Name);
       if (index == -1) {
         continue;
       }
 
-      this->Properties[index]->PreviousRuns = prev;
+      auto* p = this->Properties[index];
+      p->PreviousRuns = entry.PreviousRuns;
+      p->AverageCost = entry.Cost;
+      p->CostVariance = entry.Variance;
+      p->PeakMemory = entry.PeakMemory;
       // When not running in parallel mode, don't use cost data
-      if (this->ParallelLevel > 1 && this->Properties[index] &&
-          this->Properties[index]->Cost == 0) {
-        this->Properties[index]->Cost = cost;
+      if (this->ParallelLevel > 1 && p->Cost == 0) {
+        p->Cost = entry.Cost;
       }
     }
     // Next part of the file is the failed tests
     while (std::getline(fin, line)) {
       if (!line.empty()) {
-        this->LastTestsFailed.push_back(line);
+        this->LastTestsFailed.insert(line);
       }
     }
     fin.close();
   }
+
+  uint64_t known = 0;
+  uint64_t total = 0;
+  for (auto const& p : this->Properties) {
+    if (p.second->PeakMemory > 0) {
+      ++known;
+      total += p.second->PeakMemory;
+    }
+  }
+  this->DefaultMemoryEstimate = known > 0 ? total / known : 0;
 }
 
-int cmCTestMultiProcessHandler::SearchByName(std::string const& name)
+void cmCTestMultiProcessHandler::ReadPeakMemory()
 {
-  int index = -1;
+  cmsys::ifstream fin(this->CTest->GetCostDataFile().c_str());
+  std::string line;
+  CostEntry entry;
+  while (std::getline(fin, line) && line != "---") {
+    if (!ParseCostEntry(line, entry)) {
+      break;
+    }
+    int index = this->SearchByName(entry.Name);
+    if (index != -1) {
+      this->Properties[index]->PeakMemory = entry.PeakMemory;
+    }
+  }
+}
 
-  for (auto const& p : this->Properties) {
-    if (p.second->Name == name) {
-      index = p.first;
+std::unordered_map<std::string, float>
+cmCTestMultiProcessHandler::ReadCostEstimates(std::string const& fname)
+{
+  std::unordered_map<std::string, float> costs;
+  cmsys::ifstream fin(fname.c_str());
+  std::string line;
+  CostEntry entry;
+  while (std::getline(fin, line) && line != "---") {
+    if (!ParseCostEntry(line, entry)) {
+      break;
     }
+    costs[entry.Name] = entry.Cost;
+  }
+  return costs;
+}
+
+int cmCTestMultiProcessHandler::SearchByName(std::string const& name) const
+{
+  auto const it = this->TestsByName.find(name);
+  if (it == this->TestsByName.end()) {
+    return -1;
   }
-  return index;
+  return it->second;
 }
 
 void cmCTestMultiProcessHandler::CreateTestCostList()
 {
-  if (this->ParallelLevel > 1) {
+  if (this->ParallelLevel > 1 &&
+      this->CTest->GetScheduleType() == "CriticalPath") {
+    this->CreateCriticalPathTestCostList();
+  } else if (this->ParallelLevel > 1) {
     this->CreateParallelTestCostList();
   } else {
     this->CreateSerialTestCostList();
@@ -857,6 +1012,182 @@ void cmCTestMultiProcessHandler::CreateParallelTestCostList()
   }
 }
 
+void cmCTestMultiProcessHandler::CreateCriticalPathTestCostList()
+{
+  // Tests without cost history are assumed to take as long as the
+  // average test that has one.
+  double knownCost = 0;
+  size_t knownCount = 0;
+  for (auto const& t : this->Tests) {
+    float const cost = this->Properties[t.first]->Cost;
+    if (cost > 0) {
+      knownCost += cost;
+      ++knownCount;
+    }
+  }
+  double const defaultCost =
+    knownCount > 0 ? knownCost / static_cast<double>(knownCount) : 1.0;
+
+  std::unordered_map<int, double> costs;
+  std::unordered_map<int, std::vector<int>> dependents;
+  costs.reserve(this->Tests.size());
+  dependents.reserve(this->Tests.size());
+  for (auto const& t : this->Tests) {
+    float const cost = this->Properties[t.first]->Cost;
+    costs[t.first] = cost > 0 ? static_cast<double>(cost) : defaultCost;
+    dependents[t.first];
+  }
+  for (auto const& t : this->Tests) {
+    for (int d : t.second) {
+      auto it = dependents.find(d);
+      if (it != dependents.end()) {
+        it->second.push_back(t.first);
+      }
+    }
+  }
+
+  // Visit each test after all tests that depend on it, so the longest
+  // path from the test to the end of the run is known when it is reached.
+  // The graph has been checked for cycles already.
+  std::unordered_map<int, size_t> waiting;
+  std::unordered_map<int, double> pathAfter;
+  std::unordered_map<int, double> criticalPath;
+  std::vector<int> ready;
+  waiting.reserve(this->Tests.size());
+  criticalPath.reserve(this->Tests.size());
+  for (auto const& d : dependents) {
+    waiting[d.first] = d.second.size();
+    if (d.second.empty()) {
+      ready.push_back(d.first);
+    }
+  }
+  while (!ready.empty()) {
+    int const test = ready.back();
+    ready.pop_back();
+    double const path = costs[test] + pathAfter[test];
+    criticalPath[test] = path;
+    for (int d : this->Tests[test]) {
+      auto it = waiting.find(d);
+      if (it == waiting.end()) {
+        continue;
+      }
+      double& after = pathAfter[d];
+      after = std::max(after, path);
+      if (--it->second == 0) {
+        ready.push_back(d);
+      }
+    }
+  }
+
+  // Start the test with the longest remaining path first.  A test always
+  // has a longer path than the tests depending on it, so dependencies
+  // are still queued before their dependents.
+  TestList sortedTests;
+  sortedTests.reserve(this->Tests.size());
+  for (auto const& t : this->Tests) {
+    sortedTests.push_back(t.first);
+  }
+  std::stable_sort(sortedTests.begin(), sortedTests.end(),
+                   [&criticalPath](int l, int r) {
+                     return criticalPath[l] > criticalPath[r];
+                   });
+  cm::append(this->SortedTests, sortedTests);
+
+  double longest = 0;
+  for (auto const& p : criticalPath) {
+    longest = std::max(longest, p.second);
+  }
+  this->CriticalPathLength = cmDuration(longest);
+  this->PredictedMakespan = this->PredictMakespan(costs, dependents);
+}
+
+cmDuration cmCTestMultiProcessHandler::PredictMakespan(
+  std::unordered_map<int, double> const& costs,
+  std::unordered_map<int, std::vector<int>> const& dependents)
+{
+  // Replay the greedy list schedule used by StartNextTests, in the order
+  // of SortedTests, with every test taking its estimated cost.
+  std::unordered_map<int, size_t> rank;
+  std::unordered_map<int, size_t> waiting;
+  rank.reserve(this->SortedTests.size());
+  waiting.reserve(this->SortedTests.size());
+  for (size_t i = 0; i < this->SortedTests.size(); ++i) {
+    rank[this->SortedTests[i]] = i;
+  }
+
+  using ReadyQueue =
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>>;
+  ReadyQueue ready;
+  for (auto const& t : this->Tests) {
+    size_t count = 0;
+    for (int d : t.second) {
+      if (cm::contains(rank, d)) {
+        ++count;
+      }
+    }
+    waiting[t.first] = count;
+    if (count == 0) {
+      ready.push(rank[t.first]);
+    }
+  }
+
+  struct Running
+  {
+    double Finish;
+    int Test;
+    size_t Processors;
+    bool operator>(Running const& other) const
+    {
+      return this->Finish > other.Finish;
+    }
+  };
+  std::priority_queue<Running, std::vector<Running>, std::greater<Running>>
+    running;
+
+  double now = 0;
+  size_t freeSlots = this->ParallelLevel;
+  std::vector<size_t> skipped;
+  while (!ready.empty() || !running.empty()) {
+    while (!ready.empty() && freeSlots > 0) {
+      size_t const r = ready.top();
+      ready.pop();
+      int const test = this->SortedTests[r];
+      size_t processors = this->GetProcessorsUsed(test);
+      if (this->Properties[test]->RunSerial) {
+        if (!running.empty()) {
+          skipped.push_back(r);
+          continue;
+        }
+        processors = freeSlots;
+      }
+      if (processors > freeSlots) {
+        skipped.push_back(r);
+        continue;
+      }
+      freeSlots -= processors;
+      running.push({ now + costs.at(test), test, processors });
+    }
+    for (size_t r : skipped) {
+      ready.push(r);
+    }
+    skipped.clear();
+
+    if (running.empty()) {
+      break;
+    }
+    Running const done = running.top();
+    running.pop();
+    now = done.Finish;
+    freeSlots += done.Processors;
+    for (int d : dependents.at(done.Test)) {
+      if (--waiting[d] == 0) {
+        ready.push(rank[d]);
+      }
+    }
+  }
+  return cmDuration(now);
+}
+
 void cmCTestMultiProcessHandler::GetAllTestDependencies(int test,
                                                         TestList& dependencies)
 {
@@ -1218,6 +1549,10 @@ static Json::Value DumpCTestInfo(
   if (!properties.empty()) {
     testInfo["properties"] = properties;
   }
+  if (testProperties.PeakMemory > 0) {
+    testInfo["peakMemory"] =
+      static_cast<double>(testProperties.PeakMemory) / 1024;
+  }
   if (!testProperties.Backtrace.Empty()) {
     AddBacktrace(backtraceGraph, testInfo, testProperties.Backtrace);
   }
@@ -1235,10 +1570,15 @@ static Json::Value DumpVersion(int major, int minor)
 void cmCTestMultiProcessHandler::PrintOutputAsJson()
 {
   this->TestHandler->SetMaxIndex(this->FindMaxIndex());
+  // Show-only mode skips the cost data, but it holds the peak memory.
+  this->ReadPeakMemory();
 
   Json::Value result = Json::objectValue;
   result["kind"] = "ctestInfo";
-  result["version"] = DumpVersion(1, 0);
+  result["version"] = DumpVersion(1, 1);
+  if (this->MemoryBudget > 0) {
+    result["memoryBudget"] = static_cast<double>(this->MemoryBudget) / 1024;
+  }
 
   BacktraceData backtraceGraph;
   Json::Value tests = Json::arrayValue;
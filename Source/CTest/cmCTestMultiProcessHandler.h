@@ -4,18 +4,23 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <iosfwd>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <cm3p/uv.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "cmCTest.h"
 #include "cmCTestResourceAllocator.h"
 #include "cmCTestTestHandler.h"
+#include "cmDuration.h"
 #include "cmUVHandlePtr.h"
 
 struct cmCTestBinPackerAllocation;
@@ -59,6 +64,8 @@ public:
   // Set the max number of tests that can be run at the same time.
   void SetParallelLevel(size_t);
   void SetTestLoad(unsigned long load);
+  // Set the total peak memory in KiB that concurrent tests may use
+  void SetMemoryBudget(uint64_t kib) { this->MemoryBudget = kib; }
   virtual void RunTests();
   void PrintOutputAsJson();
   void PrintTestList();
@@ -99,6 +106,10 @@ public:
 
   void CheckResourcesAvailable();
 
+  // Read the average cost of each test listed in a cost data file
+  static std::unordered_map<std::string, float> ReadCostEstimates(
+    std::string const& fname);
+
 protected:
   // Start the next test or tests as many as are allowed by
   // ParallelLevel
@@ -110,8 +121,14 @@ protected:
 
   void UpdateCostData();
   void ReadCostData();
+  // Read only the recorded peak memory, leaving the test costs untouched
+  void ReadPeakMemory();
+  // Write one entry of the cost data file
+  static void WriteCostEntry(std::ostream& os, std::string const& name,
+                             int prev, float cost, float variance,
+                             uint64_t peakMemory);
   // Return index of a test based on its name
-  int SearchByName(std::string const& name);
+  int SearchByName(std::string const& name) const;
 
   void CreateTestCostList();
 
@@ -120,6 +137,13 @@ protected:
 
   void CreateParallelTestCostList();
 
+  // Order tests by the length of the longest dependency chain they gate
+  void CreateCriticalPathTestCostList();
+  // Simulate the schedule on ParallelLevel slots using estimated costs
+  cmDuration PredictMakespan(
+    std::unordered_map<int, double> const& costs,
+    std::unordered_map<int, std::vector<int>> const& dependents);
+
   // Removes the checkpoint file
   void MarkFinished();
   void EraseTest(int index);
@@ -134,6 +158,8 @@ protected:
   bool CheckCycles();
   int FindMaxIndex();
   inline size_t GetProcessorsUsed(int index);
+  // Predicted peak memory of a test in KiB
+  uint64_t GetMemoryEstimate(int index) const;
   std::string GetName(int index);
 
   bool CheckStopOnFailure();
@@ -168,16 +194,27 @@ protected:
   size_t Completed;
   size_t RunningCount;
   std::set<size_t> ProcessorsAvailable;
+  // Memory budget in KiB and the amount reserved by running tests
+  uint64_t MemoryBudget = 0;
+  uint64_t MemoryInUse = 0;
+  // Estimate for tests never measured: the average of the known peaks
+  uint64_t DefaultMemoryEstimate = 0;
+  std::map<int, uint64_t> ReservedMemory;
   size_t HaveAffinity;
   bool StopTimePassed = false;
+  // Estimates made by the critical path schedule, zero if not used
+  cmDuration PredictedMakespan = cmDuration::zero();
+  cmDuration CriticalPathLength = cmDuration::zero();
   // list of test properties (indices concurrent to the test map)
   PropertiesMap Properties;
+  // map from test name to test index, built once in SetTests
+  std::unordered_map<std::string, int> TestsByName;
   std::map<int, bool> TestRunningMap;
   std::map<int, bool> TestFinishMap;
   std::map<int, std::string> TestOutput;
   std::vector<std::string>* Passed;
   std::vector<std::string>* Failed;
-  std::vector<std::string> LastTestsFailed;
+  std::unordered_set<std::string> LastTestsFailed;
   std::set<std::string> LockedResources;
   std::map<int,
            std::vector<std::map<std::string, std::vector<ResourceAllocation>>>>
@@ -2,6 +2,7 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmCTestRunTest.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef> // IWYU pragma: keep
 #include <cstdint>
@@ -14,11 +15,13 @@
 
 #include <cm/memory>
 
+#include "cmsys/FStream.hxx"
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmCTest.h"
 #include "cmCTestMemCheckHandler.h"
 #include "cmCTestMultiProcessHandler.h"
+#include "cmGeneratedFileStream.h"
 #include "cmProcess.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
@@ -30,23 +33,30 @@ cmCTestRunTest::cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler)
   this->CTest = multiHandler.CTest;
   this->TestHandler = multiHandler.TestHandler;
   this->TestResult.ExecutionTime = cmDuration::zero();
+  this->TestResult.PeakMemory = 0;
   this->TestResult.ReturnValue = 0;
   this->TestResult.Status = cmCTestTestHandler::NOT_RUN;
   this->TestResult.TestCount = 0;
   this->TestResult.Properties = nullptr;
 }
 
+cmCTestRunTest::~cmCTestRunTest() = default;
+
 void cmCTestRunTest::CheckOutput(std::string const& line)
 {
   cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
              this->GetIndex() << ": " << line << std::endl);
-  this->ProcessOutput += line;
-  this->ProcessOutput += "\n";
+  if (this->StreamOutput) {
+    this->StreamOutputLine(line);
+  } else {
+    this->ProcessOutput += line;
+    this->ProcessOutput += "\n";
+  }
 
   // Check for TIMEOUT_AFTER_MATCH property.
   if (!this->TestProperties->TimeoutRegularExpressions.empty()) {
     for (auto& reg : this->TestProperties->TimeoutRegularExpressions) {
-      if (reg.first.find(this->ProcessOutput)) {
+      if (reg.first.find(this->StreamOutput ? line : this->ProcessOutput)) {
         cmCTestLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
                    this->GetIndex()
                      << ": "
@@ -65,8 +75,263 @@ void cmCTestRunTest::CheckOutput(std::string const& line)
   }
 }
 
+void cmCTestRunTest::StartOutputCapture()
+{
+  this->StreamOutput =
+    this->CTest->GetStreamTestOutput() && !this->TestHandler->MemCheck;
+  this->OutputBounded = false;
+  this->OutputOverflowed = false;
+  this->InMeasurement = false;
+  this->OutputBytes = 0;
+  this->OutputTail.clear();
+  this->OutputTailPos = 0;
+  this->OutputTailUsed = 0;
+  this->OutputMeasurements.clear();
+  this->OutputPendingMeasurement.clear();
+  this->OutputSpillFile.clear();
+  this->OutputSpill.reset();
+  if (!this->StreamOutput) {
+    return;
+  }
+
+  this->RequiredMatched.assign(
+    this->TestProperties->RequiredRegularExpressions.size(), false);
+  this->ErrorMatched.assign(
+    this->TestProperties->ErrorRegularExpressions.size(), false);
+  this->SkipMatched.assign(
+    this->TestProperties->SkipRegularExpressions.size(), false);
+
+  // Keep enough output for whichever of the two limits applies at the end.
+  // A limit of zero means the output is not truncated at all.
+  int const passed = this->TestHandler->CustomMaximumPassedTestOutputSize;
+  int const failed = this->TestHandler->CustomMaximumFailedTestOutputSize;
+  this->OutputBounded = passed > 0 && failed > 0;
+  this->OutputCaptureSize =
+    this->OutputBounded ? static_cast<size_t>(std::max(passed, failed)) : 0;
+  this->OutputHeadSize = this->OutputCaptureSize / 2;
+}
+
+static void MatchOutputLine(
+  std::vector<std::pair<cmsys::RegularExpression, std::string>>& regexes,
+  std::vector<bool>& matched, std::string const& line)
+{
+  for (size_t i = 0; i < regexes.size(); ++i) {
+    if (!matched[i] && regexes[i].first.find(line)) {
+      matched[i] = true;
+    }
+  }
+}
+
+void cmCTestRunTest::StreamOutputLine(std::string const& line)
+{
+  // Match the expressions that decide the result while the output is
+  // still at hand, since most of it will not be kept.
+  MatchOutputLine(this->TestProperties->RequiredRegularExpressions,
+                  this->RequiredMatched, line);
+  MatchOutputLine(this->TestProperties->ErrorRegularExpressions,
+                  this->ErrorMatched, line);
+  MatchOutputLine(this->TestProperties->SkipRegularExpressions,
+                  this->SkipMatched, line);
+
+  if (this->OutputSpill) {
+    *this->OutputSpill << line << "\n";
+  }
+
+  if (!this->OutputBounded) {
+    this->ProcessOutput += line;
+    this->ProcessOutput += "\n";
+    return;
+  }
+
+  // The test asked for all of its output, keep everything from now on.
+  if (line.find("CTEST_FULL_OUTPUT") != std::string::npos) {
+    this->OutputBounded = false;
+    if (!this->OutputOverflowed) {
+      this->ProcessOutput += line;
+      this->ProcessOutput += "\n";
+    } else if (!this->ReadSpilledOutput()) {
+      // Without the spill file the middle is lost, so say so.
+      this->ComposeOutput();
+      this->ProcessOutput += line;
+      this->ProcessOutput += "\n";
+    }
+    return;
+  }
+
+  this->OutputBytes += line.size() + 1;
+  if (!this->OutputOverflowed) {
+    if (this->ProcessOutput.size() + line.size() + 1 <= this->OutputHeadSize) {
+      this->ProcessOutput += line;
+      this->ProcessOutput += "\n";
+      return;
+    }
+
+    // The head is full.  From here on only a tail is kept in memory and
+    // the complete output goes to disk.
+    this->OutputOverflowed = true;
+    this->OutputTail.resize(this->OutputCaptureSize - this->OutputHeadSize);
+    this->OutputSpillFile =
+      cmStrCat(this->CTest->GetBinaryDir(), "/Testing/Temporary/TestOutput-",
+               this->Index, ".log");
+    this->OutputSpill =
+      cm::make_unique<cmGeneratedFileStream>(this->OutputSpillFile, true);
+    this->OutputSpill->SetCompression(true);
+    if (*this->OutputSpill) {
+      *this->OutputSpill << this->ProcessOutput << line << "\n";
+    } else {
+      this->OutputSpill.reset();
+      this->OutputSpillFile.clear();
+    }
+  }
+
+  // Keep measurements whole so that DartProcessing still finds them, but
+  // only as long as they fit the capture size.  A larger or unterminated
+  // measurement is treated as ordinary output.
+  if (this->InMeasurement ||
+      line.find("<DartMeasurement") != std::string::npos) {
+    this->InMeasurement =
+      line.find("</DartMeasurement") == std::string::npos;
+    this->OutputPendingMeasurement += line;
+    this->OutputPendingMeasurement += "\n";
+    if (this->OutputMeasurements.size() +
+          this->OutputPendingMeasurement.size() >
+        this->OutputCaptureSize) {
+      this->InMeasurement = false;
+      this->AppendOutputTail(this->OutputPendingMeasurement.data(),
+                             this->OutputPendingMeasurement.size());
+      this->OutputPendingMeasurement.clear();
+    } else if (!this->InMeasurement) {
+      this->OutputMeasurements += this->OutputPendingMeasurement;
+      this->OutputPendingMeasurement.clear();
+    }
+    return;
+  }
+
+  this->AppendOutputTail(line.data(), line.size());
+  this->AppendOutputTail("\n", 1);
+}
+
+void cmCTestRunTest::AppendOutputTail(char const* data, size_t size)
+{
+  size_t const capacity = this->OutputTail.size();
+  if (capacity == 0) {
+    return;
+  }
+  // Only the end of a chunk larger than the ring can survive.
+  if (size > capacity) {
+    data += size - capacity;
+    size = capacity;
+  }
+  while (size > 0) {
+    size_t const chunk = std::min(size, capacity - this->OutputTailPos);
+    std::copy(data, data + chunk, this->OutputTail.begin() +
+                static_cast<std::ptrdiff_t>(this->OutputTailPos));
+    this->OutputTailPos = (this->OutputTailPos + chunk) % capacity;
+    this->OutputTailUsed = std::min(capacity, this->OutputTailUsed + chunk);
+    data += chunk;
+    size -= chunk;
+  }
+}
+
+bool cmCTestRunTest::ReadSpilledOutput()
+{
+  // The spill file holds the complete output so far, including the
+  // line that is being processed.
+  if (!this->OutputSpill || !this->OutputSpill->flush()) {
+    return false;
+  }
+  cmsys::ifstream fin(this->OutputSpill->GetTempName().c_str(),
+                      std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::ostringstream content;
+  content << fin.rdbuf();
+  this->ProcessOutput = content.str();
+
+  std::vector<char>().swap(this->OutputTail);
+  this->OutputTailPos = 0;
+  this->OutputTailUsed = 0;
+  this->OutputMeasurements.clear();
+  this->OutputPendingMeasurement.clear();
+  this->InMeasurement = false;
+  return true;
+}
+
+void cmCTestRunTest::ComposeOutput()
+{
+  // An unterminated measurement is ordinary output after all.
+  this->AppendOutputTail(this->OutputPendingMeasurement.data(),
+                         this->OutputPendingMeasurement.size());
+  this->OutputPendingMeasurement.clear();
+  this->InMeasurement = false;
+
+  // Unroll the ring in order.
+  size_t const capacity = this->OutputTail.size();
+  std::string tail;
+  tail.reserve(this->OutputTailUsed);
+  if (capacity > 0) {
+    size_t const start =
+      (this->OutputTailPos + capacity - this->OutputTailUsed) % capacity;
+    for (size_t i = 0; i < this->OutputTailUsed; ++i) {
+      tail += this->OutputTail[(start + i) % capacity];
+    }
+  }
+  // Do not start in the middle of a multi-byte UTF-8 encoding.
+  size_t skip = 0;
+  while (skip < tail.size() &&
+         (static_cast<unsigned char>(tail[skip]) & 0xC0) == 0x80) {
+    ++skip;
+  }
+  tail.erase(0, skip);
+
+  size_t const removed = this->OutputBytes - this->ProcessOutput.size() -
+    tail.size() - this->OutputMeasurements.size();
+  std::ostringstream msg;
+  msg << "...\n"
+      << removed
+      << " bytes of the test output were removed since it exceeds the "
+         "threshold of "
+      << this->OutputCaptureSize << " bytes.\n";
+  if (!this->OutputSpillFile.empty()) {
+    msg << "The complete output is in " << this->OutputSpillFile << ".gz\n";
+  }
+  msg << "...\n";
+  this->ProcessOutput += msg.str();
+  this->ProcessOutput += tail;
+  this->ProcessOutput += this->OutputMeasurements;
+
+  std::vector<char>().swap(this->OutputTail);
+  this->OutputTailPos = 0;
+  this->OutputTailUsed = 0;
+  this->OutputMeasurements.clear();
+}
+
+void cmCTestRunTest::FinishOutputCapture()
+{
+  if (this->OutputBounded && this->OutputOverflowed) {
+    this->ComposeOutput();
+  }
+  if (this->OutputSpill) {
+    this->OutputSpill->Close();
+    this->OutputSpill.reset();
+  }
+}
+
+bool cmCTestRunTest::OutputMatches(cmsys::RegularExpression& regex,
+                                   std::vector<bool> const& matched, size_t i)
+{
+  if (this->StreamOutput) {
+    return matched[i];
+  }
+  return regex.find(this->ProcessOutput);
+}
+
 bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
 {
+  if (this->StreamOutput) {
+    this->FinishOutputCapture();
+  }
   this->WriteLogOutputTop(completed, total);
   std::string reason;
   bool passed = true;
@@ -83,11 +348,12 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   if (!this->TestProperties->RequiredRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
     bool found = false;
-    for (auto& pass : this->TestProperties->RequiredRegularExpressions) {
-      if (pass.first.find(this->ProcessOutput)) {
+    auto& required = this->TestProperties->RequiredRegularExpressions;
+    for (size_t i = 0; i < required.size(); ++i) {
+      if (this->OutputMatches(required[i].first, this->RequiredMatched, i)) {
         found = true;
         reason = cmStrCat("Required regular expression found. Regex=[",
-                          pass.second, ']');
+                          required[i].second, ']');
         break;
       }
     }
@@ -103,10 +369,11 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   }
   if (!this->TestProperties->ErrorRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
-    for (auto& fail : this->TestProperties->ErrorRegularExpressions) {
-      if (fail.first.find(this->ProcessOutput)) {
+    auto& errors = this->TestProperties->ErrorRegularExpressions;
+    for (size_t i = 0; i < errors.size(); ++i) {
+      if (this->OutputMatches(errors[i].first, this->ErrorMatched, i)) {
         reason = cmStrCat("Error regular expression found in output. Regex=[",
-                          fail.second, ']');
+                          errors[i].second, ']');
         forceFail = true;
         break;
       }
@@ -114,10 +381,11 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   }
   if (!this->TestProperties->SkipRegularExpressions.empty() &&
       this->FailedDependencies.empty()) {
-    for (auto& skip : this->TestProperties->SkipRegularExpressions) {
-      if (skip.first.find(this->ProcessOutput)) {
+    auto& skips = this->TestProperties->SkipRegularExpressions;
+    for (size_t i = 0; i < skips.size(); ++i) {
+      if (this->OutputMatches(skips[i].first, this->SkipMatched, i)) {
         reason = cmStrCat("Skip regular expression found in output. Regex=[",
-                          skip.second, ']');
+                          skips[i].second, ']');
         forceSkip = true;
         break;
       }
@@ -234,12 +502,17 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
   // if this is doing MemCheck then all the output needs to be put into
   // Output since that is what is parsed by cmCTestMemCheckHandler
   if (!this->TestHandler->MemCheck && started) {
-    this->TestHandler->CleanTestOutput(
-      this->ProcessOutput,
-      static_cast<size_t>(
-        this->TestResult.Status == cmCTestTestHandler::COMPLETED
-          ? this->TestHandler->CustomMaximumPassedTestOutputSize
-          : this->TestHandler->CustomMaximumFailedTestOutputSize));
+    size_t const length = static_cast<size_t>(
+      this->TestResult.Status == cmCTestTestHandler::COMPLETED
+        ? this->TestHandler->CustomMaximumPassedTestOutputSize
+        : this->TestHandler->CustomMaximumFailedTestOutputSize);
+    // A streaming capture that overflowed already kept the head and tail
+    // within the larger limit; truncating it again would drop the tail.
+    bool const captured = this->OutputBounded && this->OutputOverflowed &&
+      length >= this->OutputCaptureSize;
+    if (!captured) {
+      this->TestHandler->CleanTestOutput(this->ProcessOutput, length);
+    }
   }
   this->TestResult.Reason = reason;
   if (this->TestHandler->LogFile) {
@@ -303,6 +576,10 @@ bool cmCTestRunTest::EndTest(size_t completed, size_t total, bool started)
       this->TestResult.CompletionStatus = "Completed";
     }
     this->TestResult.ExecutionTime = this->TestProcess->GetTotalTime();
+    this->TestResult.PeakMemory = this->TestProcess->GetPeakMemory();
+    if (this->TestResult.PeakMemory > 0) {
+      this->TestProperties->PeakMemory = this->TestResult.PeakMemory;
+    }
     this->MemCheckPostProcess();
     this->ComputeWeightedCost();
   }
@@ -367,12 +644,20 @@ bool cmCTestRunTest::NeedsToRepeat()
 void cmCTestRunTest::ComputeWeightedCost()
 {
   double prev = static_cast<double>(this->TestProperties->PreviousRuns);
-  double avgcost = static_cast<double>(this->TestProperties->Cost);
+  double avgcost = static_cast<double>(this->TestProperties->AverageCost);
+  double variance = static_cast<double>(this->TestProperties->CostVariance);
   double current = this->TestResult.ExecutionTime.count();
 
   if (this->TestResult.Status == cmCTestTestHandler::COMPLETED) {
-    this->TestProperties->Cost =
-      static_cast<float>(((prev * avgcost) + current) / (prev + 1.0));
+    // Update the running mean and variance incrementally (Welford) so the
+    // cost data file only needs to keep the summary of previous runs.
+    double newcost = ((prev * avgcost) + current) / (prev + 1.0);
+    double m2 =
+      (variance * prev) + ((current - avgcost) * (current - newcost));
+    this->TestProperties->Cost = static_cast<float>(newcost);
+    this->TestProperties->AverageCost = static_cast<float>(newcost);
+    this->TestProperties->CostVariance =
+      static_cast<float>(std::max(m2 / (prev + 1.0), 0.0));
     this->TestProperties->PreviousRuns++;
   }
 }
@@ -426,6 +711,7 @@ void cmCTestRunTest::StartFailure(std::string const& output,
 
   this->TestResult.Properties = this->TestProperties;
   this->TestResult.ExecutionTime = cmDuration::zero();
+  this->TestResult.PeakMemory = 0;
   this->TestResult.CompressOutput = false;
   this->TestResult.ReturnValue = -1;
   this->TestResult.CompletionStatus = detail;
@@ -492,9 +778,11 @@ bool cmCTestRunTest::StartTest(size_t completed, size_t total)
   }
 
   this->ProcessOutput.clear();
+  this->StartOutputCapture();
 
   this->TestResult.Properties = this->TestProperties;
   this->TestResult.ExecutionTime = cmDuration::zero();
+  this->TestResult.PeakMemory = 0;
   this->TestResult.CompressOutput = false;
   this->TestResult.ReturnValue = -1;
   this->TestResult.TestCount = this->TestProperties->Index;
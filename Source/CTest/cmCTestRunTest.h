@@ -12,12 +12,16 @@
 
 #include <stddef.h>
 
+#include "cmsys/RegularExpression.hxx"
+
 #include "cmCTest.h"
 #include "cmCTestMultiProcessHandler.h"
 #include "cmCTestTestHandler.h"
 #include "cmDuration.h"
 #include "cmProcess.h"
 
+class cmGeneratedFileStream;
+
 /** \class cmRunTest
  * \brief represents a single test to be run
  *
@@ -27,6 +31,7 @@ class cmCTestRunTest
 {
 public:
   explicit cmCTestRunTest(cmCTestMultiProcessHandler& multiHandler);
+  ~cmCTestRunTest();
 
   void SetNumberOfRuns(int n)
   {
@@ -118,6 +123,16 @@ private:
   // Run post processing of the process output for MemCheck
   void MemCheckPostProcess();
 
+  // Bounded capture of the output for --test-output-streaming
+  void StartOutputCapture();
+  void StreamOutputLine(std::string const& line);
+  void AppendOutputTail(char const* data, size_t size);
+  void ComposeOutput();
+  bool ReadSpilledOutput();
+  void FinishOutputCapture();
+  bool OutputMatches(cmsys::RegularExpression& regex,
+                     std::vector<bool> const& matched, size_t i);
+
   void SetupResourcesEnvironment(std::vector<std::string>* log = nullptr);
 
   // Returns "completed/total Test #Index: "
@@ -130,6 +145,25 @@ private:
   cmCTest* CTest;
   std::unique_ptr<cmProcess> TestProcess;
   std::string ProcessOutput;
+  // With StreamOutput, ProcessOutput holds only the head of the output
+  // until OutputBounded is cleared, and the rest goes to a tail ring.
+  bool StreamOutput = false;
+  bool OutputBounded = false;
+  bool OutputOverflowed = false;
+  bool InMeasurement = false;
+  size_t OutputCaptureSize = 0;
+  size_t OutputHeadSize = 0;
+  size_t OutputBytes = 0;
+  std::vector<char> OutputTail;
+  size_t OutputTailPos = 0;
+  size_t OutputTailUsed = 0;
+  std::string OutputMeasurements;
+  std::string OutputPendingMeasurement;
+  std::string OutputSpillFile;
+  std::unique_ptr<cmGeneratedFileStream> OutputSpill;
+  std::vector<bool> RequiredMatched;
+  std::vector<bool> ErrorMatched;
+  std::vector<bool> SkipMatched;
   // The test results
   cmCTestTestHandler::cmCTestTestResult TestResult;
   cmCTestMultiProcessHandler& MultiTestHandler;
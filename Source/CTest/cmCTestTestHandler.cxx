@@ -15,6 +15,7 @@
 #include <iterator>
 #include <set>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
 #include <cm/memory>
@@ -22,6 +23,10 @@
 #include <cmext/algorithm>
 #include <cmext/string_view>
 
+#include <cm3p/json/reader.h>
+#include <cm3p/json/value.h>
+#include <cm3p/json/writer.h>
+
 #include "cmsys/FStream.hxx"
 #include <cmsys/Base64.h>
 #include <cmsys/Directory.hxx>
@@ -449,6 +454,9 @@ int cmCTestTestHandler::ProcessHandler()
     }
 
     cmDuration durationInSecs = clock_finish - clock_start;
+    if (!this->ShardResultFiles.empty()) {
+      durationInSecs = this->ElapsedTestingTime;
+    }
     this->LogTestSummary(passed, failed, durationInSecs);
 
     this->LogDisabledTests(disabledTests);
@@ -511,6 +519,27 @@ bool cmCTestTestHandler::ProcessOptions()
       return false;
     }
   }
+  this->ShardIndex = 0;
+  this->ShardCount = 0;
+  if (const char* shard = this->GetOption("Shard")) {
+    cmsys::RegularExpression shardRegex("^([0-9]+)/([0-9]+)$");
+    if (!shardRegex.find(shard) ||
+        !cmStrToULong(shardRegex.match(1), &this->ShardIndex) ||
+        !cmStrToULong(shardRegex.match(2), &this->ShardCount) ||
+        this->ShardIndex < 1 || this->ShardIndex > this->ShardCount) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Shard option invalid value: " << shard << std::endl);
+      return false;
+    }
+  }
+  this->ShardCostData.clear();
+  if (const char* costs = this->GetOption("ShardCostData")) {
+    this->ShardCostData = costs;
+  }
+  this->ShardResultFiles.clear();
+  if (const char* merge = this->GetOption("MergeShards")) {
+    cmExpandList(merge, this->ShardResultFiles);
+  }
   if (this->GetOption("ParallelLevel")) {
     this->CTest->SetParallelLevel(atoi(this->GetOption("ParallelLevel")));
   }
@@ -1163,6 +1192,403 @@ void cmCTestTestHandler::UpdateMaxTestNameWidth()
   }
 }
 
+void cmCTestTestHandler::SelectShard()
+{
+  // The cost data of this build tree changes with every run, so it would
+  // give each shard a different split.  Only a cost file that is given
+  // explicitly, and is therefore the same for all shards, is used.
+  std::unordered_map<std::string, float> history;
+  if (!this->ShardCostData.empty()) {
+    history =
+      cmCTestMultiProcessHandler::ReadCostEstimates(this->ShardCostData);
+  }
+
+  std::size_t const count = this->TestList.size();
+  std::unordered_map<std::string, std::size_t> byName;
+  byName.reserve(count);
+  this->ShardTestNames.clear();
+  this->ShardTestNames.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    byName.emplace(this->TestList[i].Name, i);
+    this->ShardTestNames.push_back(this->TestList[i].Name);
+  }
+
+  // Group tests connected through DEPENDS, which also covers the setup
+  // and cleanup tests of fixtures.  The root of each group is its first
+  // test in the list.
+  std::vector<std::size_t> root(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    root[i] = i;
+  }
+  auto findRoot = [&root](std::size_t i) {
+    while (root[i] != i) {
+      root[i] = root[root[i]];
+      i = root[i];
+    }
+    return i;
+  };
+  for (std::size_t i = 0; i < count; ++i) {
+    for (std::string const& dep : this->TestList[i].Depends) {
+      auto it = byName.find(dep);
+      if (it == byName.end()) {
+        continue;
+      }
+      std::size_t const a = findRoot(i);
+      std::size_t const b = findRoot(it->second);
+      if (a != b) {
+        root[std::max(a, b)] = std::min(a, b);
+      }
+    }
+  }
+
+  // Tests without a cost are assumed to take as long as the average test
+  // that has one.
+  std::vector<double> costs(count, 0);
+  double knownCost = 0;
+  std::size_t knownCount = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    cmCTestTestProperties const& p = this->TestList[i];
+    double cost = p.Cost;
+    if (cost <= 0) {
+      auto it = history.find(p.Name);
+      if (it != history.end()) {
+        cost = it->second;
+      }
+    }
+    if (cost > 0) {
+      knownCost += cost;
+      ++knownCount;
+    }
+    costs[i] = cost;
+  }
+  double const defaultCost =
+    knownCount > 0 ? knownCost / static_cast<double>(knownCount) : 1.0;
+
+  struct ShardGroup
+  {
+    std::size_t First = 0;
+    double Cost = 0;
+    bool UsesResources = false;
+  };
+  std::vector<ShardGroup> groups;
+  std::vector<std::size_t> groupOf(count);
+  std::unordered_map<std::size_t, std::size_t> groupByRoot;
+  for (std::size_t i = 0; i < count; ++i) {
+    std::size_t const r = findRoot(i);
+    auto inserted = groupByRoot.emplace(r, groups.size());
+    if (inserted.second) {
+      groups.emplace_back();
+      groups.back().First = r;
+    }
+    ShardGroup& group = groups[inserted.first->second];
+    cmCTestTestProperties const& p = this->TestList[i];
+    double const cost = costs[i] > 0 ? costs[i] : defaultCost;
+    group.Cost += cost * std::max(p.Processors, 1);
+    group.UsesResources = group.UsesResources || !p.ResourceGroups.empty();
+    groupOf[i] = inserted.first->second;
+  }
+
+  // Place the most expensive groups first, each on the shard with the
+  // least work so far.  Groups needing resources are balanced among
+  // themselves so that every shard gets a similar share of them.  The
+  // order only depends on the test list and the costs, so every shard
+  // computes the same split.
+  std::vector<std::size_t> order(groups.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&groups](std::size_t l, std::size_t r) {
+                     return groups[l].Cost > groups[r].Cost;
+                   });
+
+  std::vector<double> load(this->ShardCount, 0);
+  std::vector<double> resourceLoad(this->ShardCount, 0);
+  std::vector<unsigned long> shardOf(groups.size());
+  for (std::size_t g : order) {
+    ShardGroup const& group = groups[g];
+    std::vector<double> const& balance =
+      group.UsesResources ? resourceLoad : load;
+    unsigned long best = 0;
+    for (unsigned long s = 1; s < this->ShardCount; ++s) {
+      if (balance[s] < balance[best] ||
+          (balance[s] == balance[best] && load[s] < load[best])) {
+        best = s;
+      }
+    }
+    load[best] += group.Cost;
+    if (group.UsesResources) {
+      resourceLoad[best] += group.Cost;
+    }
+    shardOf[g] = best;
+  }
+
+  ListOfTests selected;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (shardOf[groupOf[i]] + 1 == this->ShardIndex) {
+      selected.push_back(this->TestList[i]);
+    }
+  }
+  cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                     "Shard " << this->ShardIndex << " of "
+                              << this->ShardCount << " runs "
+                              << selected.size() << " of " << count
+                              << " tests with an estimated cost of "
+                              << load[this->ShardIndex - 1] << " sec"
+                              << std::endl,
+                     this->Quiet);
+  this->TestList = std::move(selected);
+}
+
+bool cmCTestTestHandler::WriteShardResults(
+  std::vector<std::string> const& passed,
+  std::vector<std::string> const& failed)
+{
+  std::string const fname =
+    cmStrCat(this->CTest->GetBinaryDir(), "/Testing/Temporary/CTestShard-",
+             this->ShardIndex, "-of-", this->ShardCount, ".json");
+
+  std::set<std::string> const passedSet(passed.begin(), passed.end());
+  std::set<std::string> const failedSet(failed.begin(), failed.end());
+
+  Json::Value root = Json::objectValue;
+  root["kind"] = "ctestShardResults";
+  root["version"] = 1;
+  root["shard"] = static_cast<Json::UInt>(this->ShardIndex);
+  root["shards"] = static_cast<Json::UInt>(this->ShardCount);
+  root["startDateTime"] = this->StartTest;
+  root["endDateTime"] = this->EndTest;
+  root["startTestTime"] = static_cast<Json::Int64>(
+    std::chrono::system_clock::to_time_t(this->StartTestTime));
+  root["endTestTime"] = static_cast<Json::Int64>(
+    std::chrono::system_clock::to_time_t(this->EndTestTime));
+  root["elapsedTime"] = this->ElapsedTestingTime.count();
+  Json::Value allTests = Json::arrayValue;
+  for (std::string const& name : this->ShardTestNames) {
+    allTests.append(name);
+  }
+  root["allTests"] = std::move(allTests);
+
+  Json::Value tests = Json::arrayValue;
+  for (cmCTestTestResult const& result : this->TestResults) {
+    Json::Value test = Json::objectValue;
+    test["name"] = result.Name;
+    test["path"] = result.Path;
+    test["index"] = result.TestCount;
+    test["status"] = result.Status;
+    test["completionStatus"] = result.CompletionStatus;
+    test["reason"] = result.Reason;
+    test["commandLine"] = result.FullCommandLine;
+    test["environment"] = result.Environment;
+    test["executionTime"] = result.ExecutionTime.count();
+    test["peakMemory"] = static_cast<Json::UInt64>(result.PeakMemory);
+    test["returnValue"] = static_cast<Json::Int64>(result.ReturnValue);
+    test["exceptionStatus"] = result.ExceptionStatus;
+    test["compressOutput"] = result.CompressOutput;
+    test["output"] = result.Output;
+    test["dartString"] = result.DartString;
+    if (cm::contains(passedSet, result.Name)) {
+      test["result"] = "passed";
+    } else if (cm::contains(failedSet, result.Name)) {
+      test["result"] = "failed";
+    }
+
+    cmCTestTestProperties const& p = *result.Properties;
+    test["directory"] = p.Directory;
+    test["processors"] = p.Processors;
+    Json::Value labels = Json::arrayValue;
+    for (std::string const& label : p.Labels) {
+      labels.append(label);
+    }
+    test["labels"] = std::move(labels);
+    Json::Value measurements = Json::objectValue;
+    for (auto const& measure : p.Measurements) {
+      measurements[measure.first] = measure.second;
+    }
+    test["measurements"] = std::move(measurements);
+    tests.append(std::move(test));
+  }
+  root["tests"] = std::move(tests);
+
+  cmGeneratedFileStream fout(fname);
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  std::unique_ptr<Json::StreamWriter> jout(builder.newStreamWriter());
+  jout->write(root, &fout);
+  fout << "\n";
+  if (!fout.Close()) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "Cannot write shard results to " << fname << std::endl);
+    return false;
+  }
+  cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                     "Shard results written to " << fname << std::endl,
+                     this->Quiet);
+  return true;
+}
+
+bool cmCTestTestHandler::MergeShardResults(std::vector<std::string>& passed,
+                                           std::vector<std::string>& failed)
+{
+  struct MergedTest
+  {
+    cmCTestTestProperties Properties;
+    cmCTestTestResult Result;
+    std::string Kind;
+  };
+  std::vector<MergedTest> merged;
+  std::set<Json::UInt> seen;
+  std::set<std::string> reported;
+  std::vector<std::string> allTests;
+  Json::UInt shardCount = 0;
+  Json::Int64 startTime = 0;
+  Json::Int64 endTime = 0;
+  double elapsed = 0;
+
+  for (std::string const& file : this->ShardResultFiles) {
+    cmsys::ifstream fin(file.c_str());
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    if (!fin || !Json::parseFromStream(builder, fin, &root, nullptr) ||
+        !root.isObject() || root["kind"].asString() != "ctestShardResults" ||
+        root["version"].asInt() != 1) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Cannot read shard results from " << file << std::endl);
+      return false;
+    }
+    Json::UInt const shard = root["shard"].asUInt();
+    Json::UInt const shards = root["shards"].asUInt();
+    if (shardCount != 0 && shards != shardCount) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Shard results in " << file << " are for " << shards
+                                     << " shards, not " << shardCount
+                                     << std::endl);
+      return false;
+    }
+    shardCount = shards;
+    if (!seen.insert(shard).second) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Shard " << shard << " is given more than once" << std::endl);
+      return false;
+    }
+
+    Json::Int64 const shardStart = root["startTestTime"].asInt64();
+    if (seen.size() == 1 || shardStart < startTime) {
+      startTime = shardStart;
+      this->StartTest = root["startDateTime"].asString();
+    }
+    Json::Int64 const shardEnd = root["endTestTime"].asInt64();
+    if (seen.size() == 1 || shardEnd > endTime) {
+      endTime = shardEnd;
+      this->EndTest = root["endDateTime"].asString();
+    }
+    elapsed = std::max(elapsed, root["elapsedTime"].asDouble());
+
+    // All shards must have been split from the same list of tests.
+    std::vector<std::string> shardAllTests;
+    for (Json::Value const& name : root["allTests"]) {
+      shardAllTests.push_back(name.asString());
+    }
+    if (seen.size() == 1) {
+      allTests = std::move(shardAllTests);
+    } else if (shardAllTests != allTests) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Shard results in " << file
+                                     << " were split from a different list "
+                                        "of tests"
+                                     << std::endl);
+      return false;
+    }
+
+    for (Json::Value const& test : root["tests"]) {
+      std::string name = test["name"].asString();
+      if (!reported.insert(name).second) {
+        cmCTestLog(this->CTest, ERROR_MESSAGE,
+                   "Test " << name << " is reported by more than one shard"
+                           << std::endl);
+        return false;
+      }
+      merged.emplace_back();
+      MergedTest& m = merged.back();
+      cmCTestTestProperties& p = m.Properties;
+      p.Name = std::move(name);
+      p.Directory = test["directory"].asString();
+      p.Index = test["index"].asInt();
+      p.Processors = test["processors"].asInt();
+      for (Json::Value const& label : test["labels"]) {
+        p.Labels.push_back(label.asString());
+      }
+      Json::Value const& measurements = test["measurements"];
+      for (std::string const& measure : measurements.getMemberNames()) {
+        p.Measurements[measure] = measurements[measure].asString();
+      }
+
+      cmCTestTestResult& r = m.Result;
+      r.Name = p.Name;
+      r.Path = test["path"].asString();
+      r.TestCount = p.Index;
+      r.Status = test["status"].asInt();
+      r.CompletionStatus = test["completionStatus"].asString();
+      r.Reason = test["reason"].asString();
+      r.FullCommandLine = test["commandLine"].asString();
+      r.Environment = test["environment"].asString();
+      r.ExecutionTime = cmDuration(test["executionTime"].asDouble());
+      r.PeakMemory = test["peakMemory"].asUInt64();
+      r.ReturnValue = test["returnValue"].asInt64();
+      r.ExceptionStatus = test["exceptionStatus"].asString();
+      r.CompressOutput = test["compressOutput"].asBool();
+      r.Output = test["output"].asString();
+      r.DartString = test["dartString"].asString();
+      m.Kind = test["result"].asString();
+    }
+  }
+
+  std::vector<std::string> missing;
+  for (std::string const& name : allTests) {
+    if (!cm::contains(reported, name)) {
+      missing.push_back(name);
+    }
+  }
+  if (!missing.empty()) {
+    std::string msg = cmStrCat("The results of ", missing.size(), " of ",
+                               allTests.size(), " tests are missing");
+    if (seen.size() < shardCount) {
+      msg += cmStrCat(", only ", seen.size(), " of ", shardCount,
+                      " shards were given");
+    }
+    cmCTestLog(this->CTest, ERROR_MESSAGE, msg << ':' << std::endl);
+    for (std::string const& name : missing) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE, "\t" << name << std::endl);
+    }
+    return false;
+  }
+
+  std::stable_sort(merged.begin(), merged.end(),
+                   [](MergedTest const& l, MergedTest const& r) {
+                     return l.Result.TestCount < r.Result.TestCount;
+                   });
+  this->TestList.clear();
+  this->TestList.reserve(merged.size());
+  this->TestResults.clear();
+  this->TestResults.reserve(merged.size());
+  for (MergedTest& m : merged) {
+    this->TestList.push_back(std::move(m.Properties));
+    this->TestResults.push_back(std::move(m.Result));
+    this->TestResults.back().Properties = &this->TestList.back();
+    if (m.Kind == "passed") {
+      passed.push_back(this->TestList.back().Name);
+    } else if (m.Kind == "failed") {
+      failed.push_back(this->TestList.back().Name);
+    }
+  }
+  this->UpdateMaxTestNameWidth();
+
+  this->StartTestTime = std::chrono::system_clock::from_time_t(startTime);
+  this->EndTestTime = std::chrono::system_clock::from_time_t(endTime);
+  this->ElapsedTestingTime = cmDuration(elapsed);
+  return true;
+}
+
 bool cmCTestTestHandler::GetValue(const char* tag, int& value,
                                   std::istream& fin)
 {
@@ -1264,9 +1690,16 @@ bool cmCTestTestHandler::GetValue(const char* tag, std::string& value,
 bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
                                           std::vector<std::string>& failed)
 {
+  if (!this->ShardResultFiles.empty()) {
+    return this->MergeShardResults(passed, failed);
+  }
+
   if (!this->ComputeTestList()) {
     return false;
   }
+  if (this->ShardCount > 0) {
+    this->SelectShard();
+  }
 
   this->StartTest = this->CTest->CurrentTime();
   this->StartTestTime = std::chrono::system_clock::now();
@@ -1288,6 +1721,8 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
   } else {
     parallel->SetTestLoad(this->CTest->GetTestLoad());
   }
+  parallel->SetMemoryBudget(
+    static_cast<std::uint64_t>(this->CTest->GetTestMemoryBudget()) * 1024);
   if (!this->ResourceSpecFile.empty()) {
     this->UseResourceSpec = true;
     auto result = this->ResourceSpec.ReadFromJSONFile(this->ResourceSpecFile);
@@ -1359,6 +1794,10 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
     std::chrono::steady_clock::now() - elapsed_time_start;
   *this->LogFile << "End testing: " << this->CTest->CurrentTime() << std::endl;
 
+  if (this->ShardCount > 0 && !this->CTest->GetShowOnly() &&
+      !this->CTest->ShouldPrintLabels()) {
+    return this->WriteShardResults(passed, failed);
+  }
   return true;
 }
 
@@ -1409,6 +1848,20 @@ void cmCTestTestHandler::GenerateDartOutput(cmXMLWriter& xml)
       xml.Attribute("name", "Execution Time");
       xml.Element("Value", result.ExecutionTime.count());
       xml.EndElement(); // NamedMeasurement
+      if (result.PeakMemory > 0) {
+        xml.StartElement("NamedMeasurement");
+        xml.Attribute("type", "numeric/double");
+        xml.Attribute("name", "Peak Memory");
+        xml.Element("Value", static_cast<double>(result.PeakMemory) / 1024);
+        xml.EndElement(); // NamedMeasurement
+      }
+      if (this->CTest->GetTestMemoryBudget() > 0) {
+        xml.StartElement("NamedMeasurement");
+        xml.Attribute("type", "numeric/double");
+        xml.Attribute("name", "Memory Budget");
+        xml.Element("Value", this->CTest->GetTestMemoryBudget());
+        xml.EndElement(); // NamedMeasurement
+      }
       if (!result.Reason.empty()) {
         const char* reasonType = "Pass Reason";
         if (result.Status != cmCTestTestHandler::COMPLETED) {
@@ -2417,6 +2870,9 @@ bool cmCTestTestHandler::AddTest(const std::vector<std::string>& args)
   test.Timeout = cmDuration::zero();
   test.ExplicitTimeout = false;
   test.Cost = 0;
+  test.AverageCost = 0;
+  test.CostVariance = 0;
+  test.PeakMemory = 0;
   test.Processors = 1;
   test.WantAffinity = false;
   test.SkipReturnCode = -1;
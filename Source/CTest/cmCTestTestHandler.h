@@ -138,7 +138,13 @@ public:
     bool WillFail;
     bool Disabled;
     float Cost;
+    // Mean and variance of the measured cost over PreviousRuns runs, as
+    // recorded in the cost data whether or not Cost is taken from it
+    float AverageCost;
+    float CostVariance;
     int PreviousRuns;
+    // Peak resident memory in KiB of the last run that measured it
+    std::uint64_t PeakMemory;
     bool RunSerial;
     cmDuration Timeout;
     bool ExplicitTimeout;
@@ -170,6 +176,8 @@ public:
     std::string FullCommandLine;
     std::string Environment;
     cmDuration ExecutionTime;
+    // Peak resident memory in KiB, zero if not measured
+    std::uint64_t PeakMemory;
     std::int64_t ReturnValue;
     int Status;
     std::string ExceptionStatus;
@@ -301,6 +309,16 @@ private:
 
   void UpdateMaxTestNameWidth();
 
+  // keep only the tests of the selected shard, balancing the estimated
+  // cost of the shards and keeping dependent tests together
+  void SelectShard();
+  // write the results of this shard for a later merge
+  bool WriteShardResults(std::vector<std::string> const& passed,
+                         std::vector<std::string> const& failed);
+  // load the results written by the shards instead of running tests
+  bool MergeShardResults(std::vector<std::string>& passed,
+                         std::vector<std::string>& failed);
+
   bool GetValue(const char* tag, std::string& value, std::istream& fin);
   bool GetValue(const char* tag, int& value, std::istream& fin);
   bool GetValue(const char* tag, size_t& value, std::istream& fin);
@@ -348,6 +366,12 @@ private:
   void CheckLabelFilterInclude(cmCTestTestProperties& it);
 
   std::string TestsToRunString;
+  unsigned long ShardIndex = 0;
+  unsigned long ShardCount = 0;
+  std::string ShardCostData;
+  // names of all tests that were split into shards, in order
+  std::vector<std::string> ShardTestNames;
+  std::vector<std::string> ShardResultFiles;
   bool UseUnion;
   ListOfTests TestList;
   size_t TotalNumberOfTests;
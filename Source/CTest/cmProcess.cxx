@@ -3,12 +3,14 @@
 #include "cmProcess.h"
 
 #include <csignal>
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <utility>
 
 #include <cmext/algorithm>
 
+#include "cmsys/Directory.hxx"
 #include "cmsys/Process.h"
 
 #include "cmCTest.h"
@@ -19,9 +21,17 @@
 #if defined(_WIN32)
 #  include <cm3p/kwiml/int.h>
 #endif
+#if defined(__linux__)
+#  include <unistd.h>
+#endif
 
 #define CM_PROCESS_BUF_SIZE 65536
 
+// Memory sampling interval in milliseconds.  The first sample is taken
+// shortly after the spawn so that short-lived tests are still measured.
+#define CM_PROCESS_MEMORY_FIRST_SAMPLE 10
+#define CM_PROCESS_MEMORY_SAMPLE_INTERVAL 250
+
 cmProcess::cmProcess(std::unique_ptr<cmCTestRunTest> runner)
   : Runner(std::move(runner))
   , Conv(cmProcessOutput::UTF8, CM_PROCESS_BUF_SIZE)
@@ -145,11 +155,81 @@ bool cmProcess::StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity)
   this->Timer = std::move(timer);
 
   this->StartTimer();
+  this->StartMemoryTimer(loop);
 
   this->ProcessState = cmProcess::State::Executing;
   return true;
 }
 
+void cmProcess::StartMemoryTimer(uv_loop_t& loop)
+{
+  this->PeakMemory = 0;
+#if defined(__linux__)
+  if (this->MemoryTimer.init(loop, this) == 0) {
+    this->MemoryTimer.start(&cmProcess::OnMemoryTimerCB,
+                            CM_PROCESS_MEMORY_FIRST_SAMPLE,
+                            CM_PROCESS_MEMORY_SAMPLE_INTERVAL);
+  }
+#else
+  static_cast<void>(loop);
+#endif
+}
+
+void cmProcess::OnMemoryTimerCB(uv_timer_t* timer)
+{
+  auto* self = static_cast<cmProcess*>(timer->data);
+  self->SampleMemory();
+}
+
+void cmProcess::SampleMemory()
+{
+#if defined(__linux__)
+  // Sum the resident set of the test process and all of its descendants.
+  static long const pageKiB = sysconf(_SC_PAGESIZE) / 1024;
+  uint64_t total = 0;
+  std::vector<std::string> pids;
+  pids.push_back(std::to_string(this->Process->pid));
+  while (!pids.empty()) {
+    std::string pid = std::move(pids.back());
+    pids.pop_back();
+
+    std::string const proc = "/proc/" + pid;
+    if (FILE* f = fopen((proc + "/statm").c_str(), "r")) {
+      unsigned long long size = 0;
+      unsigned long long resident = 0;
+      if (fscanf(f, "%llu %llu", &size, &resident) == 2) {
+        total += static_cast<uint64_t>(resident) *
+          static_cast<uint64_t>(pageKiB);
+      }
+      fclose(f);
+    }
+    // Children are listed per thread that spawned them, so visit every
+    // task of the process rather than only its main thread.
+    cmsys::Directory tasks;
+    if (!tasks.Load(proc + "/task")) {
+      continue;
+    }
+    for (unsigned long i = 0; i < tasks.GetNumberOfFiles(); ++i) {
+      std::string const tid = tasks.GetFile(i);
+      if (tid == "." || tid == "..") {
+        continue;
+      }
+      std::string const children = proc + "/task/" + tid + "/children";
+      if (FILE* f = fopen(children.c_str(), "r")) {
+        unsigned long child = 0;
+        while (fscanf(f, "%lu", &child) == 1) {
+          pids.push_back(std::to_string(child));
+        }
+        fclose(f);
+      }
+    }
+  }
+  if (total > this->PeakMemory) {
+    this->PeakMemory = total;
+  }
+#endif
+}
+
 void cmProcess::StartTimer()
 {
   auto* properties = this->Runner->GetTestProperties();
@@ -321,6 +401,7 @@ void cmProcess::OnExit(int64_t exit_status, int term_signal)
   // Record exit information.
   this->ExitValue = exit_status;
   this->Signal = term_signal;
+  this->MemoryTimer.reset();
 
   this->ProcessHandleClosed = true;
   if (this->ReadHandleClosed) {
@@ -56,6 +56,8 @@ public:
   void SetId(int id) { this->Id = id; }
   int64_t GetExitValue() { return this->ExitValue; }
   cmDuration GetTotalTime() { return this->TotalTime; }
+  // Peak resident memory of the process tree in KiB, zero if not sampled
+  uint64_t GetPeakMemory() const { return this->PeakMemory; }
 
   enum class Exception
   {
@@ -85,6 +87,8 @@ private:
   cm::uv_process_ptr Process;
   cm::uv_pipe_ptr PipeReader;
   cm::uv_timer_ptr Timer;
+  cm::uv_timer_ptr MemoryTimer;
+  uint64_t PeakMemory = 0;
   std::vector<char> Buf;
 
   std::unique_ptr<cmCTestRunTest> Runner;
@@ -95,6 +99,7 @@ private:
   static void OnExitCB(uv_process_t* process, int64_t exit_status,
                        int term_signal);
   static void OnTimeoutCB(uv_timer_t* timer);
+  static void OnMemoryTimerCB(uv_timer_t* timer);
   static void OnReadCB(uv_stream_t* stream, ssize_t nread,
                        const uv_buf_t* buf);
   static void OnAllocateCB(uv_handle_t* handle, size_t suggested_size,
@@ -106,6 +111,8 @@ private:
   void OnAllocate(size_t suggested_size, uv_buf_t* buf);
 
   void StartTimer();
+  void StartMemoryTimer(uv_loop_t& loop);
+  void SampleMemory();
   void Finish();
 
   class Buffer : public std::vector<char>
@@ -82,7 +82,8 @@ bool cmCMakeLanguageCommandCALL(std::vector<cmListFileArgument> const& args,
 
   // The rest of the arguments are passed to the function call above
   for (size_t i = startArg; i < args.size(); ++i) {
-    funcArgs.emplace_back(args[i].Value, args[i].Delim, context.Line);
+    funcArgs.push_back(args[i]);
+    funcArgs.back().Line = context.Line;
   }
   cmListFileFunction func{ callCommand, context.Line, std::move(funcArgs) };
 
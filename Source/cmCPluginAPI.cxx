@@ -424,14 +424,13 @@ int CCONV cmExecuteCommand(void* arg, const char* name, int numArgs,
 {
   cmMakefile* mf = static_cast<cmMakefile*>(arg);
 
-  std::vector<cmListFileArgument> lffArgs;
-  lffArgs.reserve(numArgs);
+  cmListFileArgumentBuilder lffArgs;
   for (int i = 0; i < numArgs; ++i) {
     // Assume all arguments are quoted.
-    lffArgs.emplace_back(args[i], cmListFileArgument::Quoted, 0);
+    lffArgs.Add(args[i], cmListFileArgument::Quoted, 0);
   }
 
-  cmListFileFunction lff{ name, 0, std::move(lffArgs) };
+  cmListFileFunction lff{ name, 0, lffArgs.Build() };
   cmExecutionStatus status(*mf);
   return mf->ExecuteCommand(lff, status);
 }
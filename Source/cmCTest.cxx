@@ -178,6 +178,8 @@ struct cmCTest::Private
 
   unsigned long TestLoad = 0;
 
+  unsigned long TestMemoryBudget = 0;
+
   int CompatibilityMode;
 
   // information for the --build-and-test options
@@ -213,6 +215,7 @@ struct cmCTest::Private
   int OutputLogFileLastTag = -1;
 
   bool OutputTestOutputOnTestFailure = false;
+  bool StreamTestOutput = false;
   bool OutputColorCode = cmCTest::ColoredOutputSupportedByConsole();
 
   std::map<std::string, std::string> Definitions;
@@ -393,6 +396,16 @@ void cmCTest::SetTestLoad(unsigned long load)
   this->Impl->TestLoad = load;
 }
 
+unsigned long cmCTest::GetTestMemoryBudget() const
+{
+  return this->Impl->TestMemoryBudget;
+}
+
+void cmCTest::SetTestMemoryBudget(unsigned long mib)
+{
+  this->Impl->TestMemoryBudget = mib;
+}
+
 bool cmCTest::ShouldCompressTestOutput()
 {
   return this->Impl->CompressTestOutput;
@@ -1924,6 +1937,19 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     }
   }
 
+  else if (this->CheckArgument(arg, "--test-memory-budget"_s) &&
+           i < args.size() - 1) {
+    i++;
+    unsigned long budget;
+    if (cmStrToULong(args[i], &budget)) {
+      this->SetTestMemoryBudget(budget);
+    } else {
+      cmCTestLog(this, WARNING,
+                 "Invalid value for 'Test Memory Budget' : " << args[i]
+                                                             << std::endl);
+    }
+  }
+
   else if (this->CheckArgument(arg, "--no-compress-output"_s)) {
     this->Impl->CompressTestOutput = false;
   }
@@ -1984,6 +2010,8 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     this->Impl->Verbose = true;
   } else if (this->CheckArgument(arg, "--output-on-failure"_s)) {
     this->Impl->OutputTestOutputOnTestFailure = true;
+  } else if (this->CheckArgument(arg, "--test-output-streaming"_s)) {
+    this->Impl->StreamTestOutput = true;
   } else if (this->CheckArgument(arg, "--test-output-size-passed"_s) &&
              i < args.size() - 1) {
     i++;
@@ -2166,6 +2194,21 @@ bool cmCTest::HandleCommandLineArguments(size_t& i,
     this->GetTestHandler()->SetPersistentOption("RerunFailed", "true");
     this->GetMemCheckHandler()->SetPersistentOption("RerunFailed", "true");
   }
+
+  else if (this->CheckArgument(arg, "--shard"_s) && i < args.size() - 1) {
+    i++;
+    this->GetTestHandler()->SetPersistentOption("Shard", args[i].c_str());
+  } else if (this->CheckArgument(arg, "--shard-cost-data"_s) &&
+             i < args.size() - 1) {
+    i++;
+    this->GetTestHandler()->SetPersistentOption("ShardCostData",
+                                                args[i].c_str());
+  } else if (this->CheckArgument(arg, "--merge-shards"_s) &&
+             i < args.size() - 1) {
+    i++;
+    this->GetTestHandler()->SetPersistentOption("MergeShards",
+                                                args[i].c_str());
+  }
   return true;
 }
 
@@ -2678,6 +2721,11 @@ int cmCTest::Run(std::vector<std::string>& args, std::string* output)
       this->Impl->ScheduleType = "Random";
     }
 
+    // --schedule-critical-path
+    if (this->CheckArgument(arg, "--schedule-critical-path"_s)) {
+      this->Impl->ScheduleType = "CriticalPath";
+    }
+
     // pass the argument to all the handlers as well, but it may no longer be
     // set to what it was originally so I'm not sure this is working as
     // intended
@@ -3274,6 +3322,11 @@ bool cmCTest::GetOutputTestOutputOnTestFailure() const
   return this->Impl->OutputTestOutputOnTestFailure;
 }
 
+bool cmCTest::GetStreamTestOutput() const
+{
+  return this->Impl->StreamTestOutput;
+}
+
 const std::map<std::string, std::string>& cmCTest::GetDefinitions() const
 {
   return this->Impl->Definitions;
@@ -122,6 +122,10 @@ public:
   unsigned long GetTestLoad() const;
   void SetTestLoad(unsigned long);
 
+  /** peak memory in MiB that concurrently running tests may use */
+  unsigned long GetTestMemoryBudget() const;
+  void SetTestMemoryBudget(unsigned long);
+
   /**
    * Check if CTest file exists
    */
@@ -433,6 +437,9 @@ public:
 
   bool GetOutputTestOutputOnTestFailure() const;
 
+  /** Whether test output is captured in bounded streaming mode */
+  bool GetStreamTestOutput() const;
+
   const std::map<std::string, std::string>& GetDefinitions() const;
 
   /** Return the number of times a test should be run */
@@ -10,6 +10,7 @@
 #include <cm/string_view>
 
 cmDefinitions::Def cmDefinitions::NoDef;
+std::size_t cmDefinitions::LookupGeneration = 0;
 
 cmDefinitions::Def const& cmDefinitions::GetInternal(const std::string& key,
                                                      StackIter begin,
@@ -37,7 +38,43 @@ cmDefinitions::Def const& cmDefinitions::GetInternal(const std::string& key,
 const std::string* cmDefinitions::Get(const std::string& key, StackIter begin,
                                       StackIter end)
 {
-  Def const& def = cmDefinitions::GetInternal(key, begin, end, false);
+  assert(begin != end);
+  {
+    auto it = begin->Map.find(cm::String::borrow(key));
+    if (it != begin->Map.end()) {
+      return it->second.Value ? it->second.Value.str_if_stable() : nullptr;
+    }
+  }
+
+  // Lookups in scopes without a parent, such as directory scopes during
+  // generation, never modify the cache.
+  StackIter parent = begin;
+  ++parent;
+  if (parent == end) {
+    return nullptr;
+  }
+
+  auto cached = begin->LookupCache.find(cm::String::borrow(key));
+  if (cached == begin->LookupCache.end()) {
+    cached = begin->LookupCache.emplace(key, CachedDef()).first;
+  } else if (cached->second.Generation == LookupGeneration) {
+    Def const& def = cached->second.Value;
+    return def.Value ? def.Value.str_if_stable() : nullptr;
+  }
+
+  Def const* found = &cmDefinitions::NoDef;
+  for (StackIter it = parent; it != end; ++it) {
+    it->SearchedFromChild = true;
+    auto mi = it->Map.find(cm::String::borrow(key));
+    if (mi != it->Map.end()) {
+      found = &mi->second;
+      break;
+    }
+  }
+  cached->second.Value = *found;
+  cached->second.Generation = LookupGeneration;
+
+  Def const& def = cached->second.Value;
   return def.Value ? def.Value.str_if_stable() : nullptr;
 }
 
@@ -100,10 +137,21 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
 
 void cmDefinitions::Set(const std::string& key, cm::string_view value)
 {
+  this->Modified();
   this->Map[key] = Def(value);
 }
 
 void cmDefinitions::Unset(const std::string& key)
 {
+  this->Modified();
   this->Map[key] = Def();
 }
+
+void cmDefinitions::Modified()
+{
+  // Lookups starting in this scope check its own definitions first, so
+  // only caches of child scopes can be affected.
+  if (this->SearchedFromChild) {
+    ++LookupGeneration;
+  }
+}
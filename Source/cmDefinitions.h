@@ -19,7 +19,9 @@
  *
  * This stores the state of variable definitions (set or unset) for
  * one scope.  Sets are always local.  Gets search parent scopes
- * transitively and save results locally.
+ * transitively and remember the result in a lookup cache of the scope
+ * the search started from.  Cached results are dropped whenever a scope
+ * that was searched through is modified.
  */
 class cmDefinitions
 {
@@ -61,8 +63,27 @@ private:
   };
   static Def NoDef;
 
+  /** Result of a lookup that searched parent scopes.  */
+  struct CachedDef
+  {
+    Def Value;
+    std::size_t Generation = 0;
+  };
+
   std::unordered_map<cm::String, Def> Map;
 
+  // Lookups that had to search parent scopes, valid while their
+  // generation matches LookupGeneration.
+  std::unordered_map<cm::String, CachedDef> LookupCache;
+
+  // Whether a lookup cache depends on the definitions in this scope.
+  bool SearchedFromChild = false;
+
+  // Bumped when a scope some lookup cache depends on is modified.
+  static std::size_t LookupGeneration;
+
+  void Modified();
+
   static Def const& GetInternal(const std::string& key, StackIter begin,
                                 StackIter end, bool raise);
 };
@@ -1,11 +1,17 @@
 /* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmExtraMalterlibGenerator.h"
+#include "cmMalterlibPathList.h"
 #include "cmMalterlibRegistry.h"
 #include "cmSystemTools.h"
 #include "cmCustomCommand.h"
 
+#include <cm/memory>
+
+#include <cmsys/FStream.hxx>
 #include <cmsys/RegularExpression.hxx>
+#include <cmsys/SystemInformation.hxx>
+#include <algorithm>
 #include <set>
 #include <sstream>
 #include <string.h>
@@ -20,7 +26,9 @@
 #include "cmMakefile.h"
 #include "cmSourceFile.h"
 #include "cmStateTypes.h"
+#include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmWorkerPool.h"
 #include "cmake.h"
 #include "cmLocalCommonGenerator.h"
 #include "cmRulePlaceholderExpander.h"
@@ -50,6 +58,12 @@ namespace
   }
 #endif
 
+#if defined(_WIN32)
+  constexpr bool CaseInsensitivePaths = true;
+#else
+  constexpr bool CaseInsensitivePaths = false;
+#endif
+
 
   std::string GetTargetName(const cmGeneratorTarget* target, std::string const &projectName) {
     std::string prefix;
@@ -139,7 +153,8 @@ namespace
     }
   }
 
-  std::string getMalterlibCompileType(std::string const &language,
+  std::string getMalterlibCompileType(cmMalterlibProjectState &project,
+                                      std::string const &language,
                                       cmLocalGenerator *localGenerator) {
     if (language.empty())
       return std::string{};
@@ -147,7 +162,7 @@ namespace
     char const *malterlibLanguage =
       cmSystemTools::GetEnv("CMAKE_MALTERLIB_LANGUAGE_" + language);
     if (!malterlibLanguage) {
-        localGenerator->GetMakefile()->IssueMessage(MessageType::FATAL_ERROR,
+        project.IssueFatalError(localGenerator->GetMakefile(),
           "Language not recognized. Please add to Property.CMake_Languages: " +
           language);
       return std::string{};
@@ -155,15 +170,9 @@ namespace
     return malterlibLanguage;
   }
 
-  struct cmMalterlibCompileTypeInfo
-  {
-    std::vector<std::string> Includes;
-    std::set<std::string> Defines;
-    std::string cStd;
-  };
-
   void AddTargetCompileInfo(
-      std::map<std::string, cmMalterlibCompileTypeInfo> &compileTypeInfo
+      cmMalterlibProjectState &project
+      , std::map<std::string, cmMalterlibCompileTypeInfo> &compileTypeInfo
       , const cmGeneratorTarget* target
       , cmLocalGenerator* lg
       , std::string const &configName)
@@ -171,7 +180,7 @@ namespace
     std::set<std::string> targetLanguages;
     target->GetLanguages(targetLanguages, configName);
     for (auto &language : targetLanguages) {
-      std::string compileType = getMalterlibCompileType(language, lg);
+      std::string compileType = getMalterlibCompileType(project, language, lg);
       if (language.empty())
         continue;
       auto &info = compileTypeInfo[compileType];
@@ -202,9 +211,12 @@ cmExtraMalterlibGenerator::GetFactory()
 
 cmExtraMalterlibGenerator::cmExtraMalterlibGenerator()
   : cmExternalMakefileProjectGenerator()
+  , HidePrefixMatcher(CaseInsensitivePaths)
+  , ReplacePrefixMatcher(CaseInsensitivePaths)
 {
   tempDir = cmSystemTools::GetEnv("CMAKE_MALTERLIB_TEMPDIR");
   baseDir = cmSystemTools::GetEnv("CMAKE_MALTERLIB_BASEDIR");
+  CompactLists = cmIsOn(cmSystemTools::GetEnv("CMAKE_MALTERLIB_COMPACTLISTS"));
 
   char const *hidePrefixesString =
     cmSystemTools::GetEnv("CMAKE_MALTERLIB_HIDEPREFIXES");
@@ -226,60 +238,268 @@ cmExtraMalterlibGenerator::cmExtraMalterlibGenerator()
       ReplacePrefixes[split[0]] = split[1];
     }
   }
+
+  for (std::size_t i = 0; i < this->HidePrefixes.size(); ++i)
+    this->HidePrefixMatcher.insert(this->HidePrefixes[i],
+                                   static_cast<std::uint32_t>(i));
+
+  // The map is sorted so the first inserted of keys that only differ in case
+  // is the one the linear search used to find
+  for (auto &prefix : this->ReplacePrefixes) {
+    this->ReplacePrefixMatcher.insert(
+      prefix.first, static_cast<std::uint32_t>(this->ReplacePrefixList.size()));
+    this->ReplacePrefixList.push_back(prefix);
+  }
 }
 
-void cmExtraMalterlibGenerator::CollectOutputFiles()
+class cmExtraMalterlibGenerator::ProjectJob : public cmWorkerPool::JobT
+{
+public:
+  ProjectJob(cmExtraMalterlibGenerator &generator,
+             cmMalterlibProjectState &project)
+    : Generator(generator)
+    , Project(project)
+  {
+  }
+
+private:
+  void Process() override { this->Generator.WriteProject(this->Project); }
+
+  cmExtraMalterlibGenerator &Generator;
+  cmMalterlibProjectState &Project;
+};
+
+namespace
 {
+  class FinishJob : public cmWorkerPool::JobFenceT
+  {
+  private:
+    void Process() override { this->Pool()->Abort(); }
+  };
+}
+
+unsigned int cmExtraMalterlibGenerator::GetThreadCount() const
+{
+  if (char const *threadsString =
+        cmSystemTools::GetEnv("CMAKE_MALTERLIB_THREADS")) {
+    unsigned long threads = 0;
+    if (cmStrToULong(threadsString, &threads) && threads > 0)
+      return static_cast<unsigned int>(threads);
+  }
+
+  cmsys::SystemInformation info;
+  info.RunCPUCheck();
+  return std::max(info.GetNumberOfPhysicalCPU(), 1u);
+}
+
+void cmExtraMalterlibGenerator::PrepareProjects()
+{
+  this->Projects.clear();
+  this->Projects.reserve(this->GlobalGenerator->GetProjectMap().size());
   for (auto &Project : this->GlobalGenerator->GetProjectMap()) {
-    auto &lgs = Project.second;
-    std::string outputDir = lgs[0]->GetCurrentBinaryDirectory();
-    std::string projectName = lgs[0]->GetProjectName();
+    this->Projects.emplace_back();
+    auto &state = this->Projects.back();
+    state.Name = Project.first;
+    state.LocalGenerators = &Project.second;
+    state.Fingerprint = cm::make_unique<cmCryptoHash>(cmCryptoHash::AlgoSHA256);
+  }
+
+  // The generator targets fill caches on first query without a lock, so
+  // everything that queries them is done here, on the main thread.
+  for (auto &Project : this->Projects)
+    this->PrepareProject(Project);
+}
+
+void cmExtraMalterlibGenerator::PrepareProject(cmMalterlibProjectState &_Project)
+{
+  auto &lgs = *_Project.LocalGenerators;
+  CollectOutputFilesFromTargets(_Project, lgs);
+  FinalizeFingerprint(_Project);
+
+  _Project.FileName = GetProjectFileName(lgs);
+  if (IsProjectUpToDate(_Project, _Project.FileName)) {
+    _Project.UpToDate = true;
+    _Project.Targets.clear();
+    return;
+  }
+
+  BuildMappedOutputMatcher(_Project);
+  ResolveTargets(_Project);
+}
+
+void cmExtraMalterlibGenerator::WriteProject(cmMalterlibProjectState &_Project)
+{
+  // Only the resolved state is used from here on, so projects can be
+  // written concurrently.
+  if (_Project.UpToDate)
+    return;
+
+  // create a project file
+  this->CreateProjectFile(_Project, *_Project.LocalGenerators);
+  _Project.Targets.clear();
 
-    const cmMakefile* mf = lgs[0]->GetMakefile();
-    CollectOutputFilesFromTargets(Project.first, lgs, mf);
+  if (_Project.FatalErrors.empty())
+    WriteFingerprint(_Project, _Project.FileName);
+}
+
+void cmExtraMalterlibGenerator::BuildMappedOutputMatcher(cmMalterlibProjectState &_Project)
+{
+  _Project.MappedOutputMatches.reserve(_Project.MappedOutputFiles.size());
+  for (auto &File : _Project.MappedOutputFiles) {
+    _Project.MappedOutputMatcher.insert(File, static_cast<std::uint32_t>(_Project.MappedOutputMatches.size()));
+    _Project.MappedOutputMatches.push_back(&File);
+  }
+}
+
+std::string cmExtraMalterlibGenerator::GetProjectFileName(const std::vector<cmLocalGenerator*>& lgs) const
+{
+  return lgs[0]->GetCurrentBinaryDirectory() + "/" + lgs[0]->GetProjectName() + ".MHeader";
+}
+
+void cmExtraMalterlibGenerator::FinalizeFingerprint(cmMalterlibProjectState &_Project)
+{
+  auto &lgs = *_Project.LocalGenerators;
+
+  // Bump when the generated output changes for the same inputs.
+  _Project.AddFingerprint("MalterlibFingerprint 2");
+
+  _Project.AddFingerprint(lgs[0]->GetProjectName());
+  _Project.AddFingerprint(lgs[0]->GetBinaryDirectory());
+  _Project.AddFingerprint(tempDir);
+  _Project.AddFingerprint(baseDir);
+  for (auto &prefix : HidePrefixes)
+    _Project.AddFingerprint(prefix);
+  _Project.AddFingerprint("ReplacePrefixes");
+  for (auto &prefix : ReplacePrefixes) {
+    _Project.AddFingerprint(prefix.first);
+    _Project.AddFingerprint(prefix.second);
+  }
+
+  _Project.AddFingerprint("MappedOutputFiles");
+  for (auto &File : _Project.MappedOutputFiles)
+    _Project.AddFingerprint(File);
+  _Project.AddFingerprint("MappedOutputDirectories");
+  for (auto &Directory : _Project.MappedOutputDirectories)
+    _Project.AddFingerprint(Directory);
+
+  _Project.AddFingerprint("ListFiles");
+  for (auto *lg : lgs) {
+    for (auto &listFile : lg->GetMakefile()->GetListFiles())
+      _Project.AddFingerprint(listFile);
+  }
+
+  _Project.FingerprintHex = _Project.Fingerprint->FinalizeHex();
+}
+
+bool cmExtraMalterlibGenerator::IsProjectUpToDate(cmMalterlibProjectState &_Project, std::string const &filename) const
+{
+  if (!_Project.FatalErrors.empty())
+    return false;
+
+  if (!cmSystemTools::FileExists(filename)
+      || !cmSystemTools::FileExists(filename + ".dependencies")
+      || !cmSystemTools::FileExists(filename + ".outputs"))
+    return false;
+
+  if (CompactLists != cmSystemTools::FileExists(filename + ".dependencies.compact")
+      || CompactLists != cmSystemTools::FileExists(filename + ".outputs.compact"))
+    return false;
+
+  cmsys::ifstream fin((filename + ".fingerprint").c_str());
+  if (!fin)
+    return false;
+
+  std::string line;
+  if (!cmSystemTools::GetLineFromStream(fin, line) || line != _Project.FingerprintHex)
+    return false;
+
+  // The remaining lines are the placeholder files written for custom
+  // command outputs. They have to be recreated if they were removed.
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (!line.empty() && !cmSystemTools::FileExists(line))
+      return false;
+  }
+
+  return true;
+}
+
+void cmExtraMalterlibGenerator::WriteFingerprint(cmMalterlibProjectState &_Project, std::string const &filename) const
+{
+  cmGeneratedFileStream fout((filename + ".fingerprint").c_str());
+  fout << _Project.FingerprintHex << "\n";
+  for (auto &Placeholder : _Project.PlaceholderFiles)
+    fout << Placeholder.first << "\n";
+}
+
+void cmExtraMalterlibGenerator::MergeProjects()
+{
+  // Projects are merged in project map order so the result does not depend
+  // on how the workers were scheduled.
+  for (auto &Project : this->Projects) {
+    if (!Project.Log.empty())
+      std::cout << Project.Log;
+
+    for (auto &Error : Project.FatalErrors)
+      Error.first->IssueMessage(MessageType::FATAL_ERROR, Error.second);
+
+    for (auto &Placeholder : Project.PlaceholderFiles) {
+      if (cmSystemTools::FileExists(Placeholder.first))
+        continue;
+      ProtectedFiles.insert(Placeholder.first);
+      cmGeneratedFileStream fout(Placeholder.first.c_str());
+      fout << Placeholder.second;
+    }
   }
 }
 
 void cmExtraMalterlibGenerator::Generate()
 {
-  CollectOutputFiles();
+  this->PrepareProjects();
+
   // for each sub project in the project create a Malterrlib Header files
-  for (auto &Project : this->GlobalGenerator->GetProjectMap()) {
-    // create a project file
-    this->CreateProjectFile(Project.first, Project.second);
+  auto outdated = std::count_if(this->Projects.begin(), this->Projects.end(),
+    [](cmMalterlibProjectState const &Project) { return !Project.UpToDate; });
+  unsigned int threadCount = std::min(
+    this->GetThreadCount(), static_cast<unsigned int>(outdated));
+  if (threadCount > 1) {
+    cmWorkerPool pool;
+    pool.SetThreadCount(threadCount);
+    for (auto &Project : this->Projects) {
+      if (!Project.UpToDate)
+        pool.EmplaceJob<ProjectJob>(*this, Project);
+    }
+    pool.EmplaceJob<FinishJob>();
+    pool.Process();
+  } else {
+    for (auto &Project : this->Projects)
+      this->WriteProject(Project);
   }
 
+  this->MergeProjects();
+
   std::set<std::string> AllOutputfiles;
-  for (auto &Files : MappedOutputFiles) {
-    for (auto &File : Files.second)
+  for (auto &Project : this->Projects) {
+    for (auto &File : Project.MappedOutputFiles)
       AllOutputfiles.insert(File);
   }
 
   {
-    cmGeneratedFileStream fout((tempDir + "/OutputFiles.list").c_str());
-    for (auto &File : AllOutputfiles) {
-        fout << File;
-        fout << "\n";
-    }
+    cmMalterlibPathList list;
+    list.AddAll(AllOutputfiles);
+    list.Write(tempDir + "/OutputFiles.list", CompactLists);
   }
   {
-    cmGeneratedFileStream fout((tempDir + "/ProtectedFiles.list").c_str());
-    for (auto &File : ProtectedFiles) {
-        fout << File;
-        fout << "\n";
-    }
+    cmMalterlibPathList list;
+    list.AddAll(ProtectedFiles);
+    list.Write(tempDir + "/ProtectedFiles.list", CompactLists);
   }
 }
 
-void cmExtraMalterlibGenerator::CreateProjectFile(std::string const &_ProjectName, const std::vector<cmLocalGenerator*>& lgs)
+void cmExtraMalterlibGenerator::CreateProjectFile(cmMalterlibProjectState &_Project, const std::vector<cmLocalGenerator*>& lgs)
 {
-  std::string outputDir = lgs[0]->GetCurrentBinaryDirectory();
-  std::string projectName = lgs[0]->GetProjectName();
-
-  const std::string filename =
-    outputDir + "/" + projectName + ".MHeader";
+  const std::string filename = GetProjectFileName(lgs);
 
-  this->CreateNewProjectFile(_ProjectName, lgs, filename);
+  this->CreateNewProjectFile(_Project, lgs, filename);
 
   {
     std::vector<std::string> lfiles;
@@ -295,23 +515,18 @@ void cmExtraMalterlibGenerator::CreateProjectFile(std::string const &_ProjectNam
       std::unique(lfiles.begin(), lfiles.end());
     lfiles.erase(new_end, lfiles.end());
 
-    cmGeneratedFileStream fout((filename + ".dependencies").c_str());
-    for (auto &dependency : lfiles)
-    {
-      fout << dependency;
-      fout << "\n";
-    }
+    cmMalterlibPathList list;
+    list.AddAll(lfiles);
+    list.Write(filename + ".dependencies", CompactLists);
   }
   {
-    cmGeneratedFileStream fout((filename + ".outputs").c_str());
-    for (auto &File : MappedOutputFiles[_ProjectName]) {
-        fout << File;
-        fout << "\n";
-    }
+    cmMalterlibPathList list;
+    list.AddAll(_Project.MappedOutputFiles);
+    list.Write(filename + ".outputs", CompactLists);
   }
 }
 
-static bool isDynamic(std::string const &_String) {
+static bool isDynamic(cm::string_view _String) {
   return _String.find("->MakeAbsolute()") != std::string::npos;
 }
 
@@ -351,7 +566,7 @@ static std::string makeIdentifier(std::string const &stringIdentifier) {
   return identifier;
 }
 
-void cmExtraMalterlibGenerator::CreateNewProjectFile(std::string const &_ProjectName,
+void cmExtraMalterlibGenerator::CreateNewProjectFile(cmMalterlibProjectState &_Project,
   const std::vector<cmLocalGenerator*>& lgs, const std::string& filename)
 {
   cmGeneratedFileStream fout(filename.c_str());
@@ -368,22 +583,17 @@ void cmExtraMalterlibGenerator::CreateNewProjectFile(std::string const &_Project
   child.RawKey = true;
   child.RawValue = true;
 
-  const cmMakefile* mf = lgs[0]->GetMakefile();
-  AppendAllTargets(_ProjectName, lgs, mf, registry);
+  AppendAllTargets(_Project, registry);
 
   registry.output(fout);
 }
 
-void cmExtraMalterlibGenerator::CollectOutputFilesFromTargets(std::string const &_ProjectName, std::vector<cmLocalGenerator *> const &lgs, const cmMakefile *mf)
+void cmExtraMalterlibGenerator::CollectOutputFilesFromTargets(cmMalterlibProjectState &_Project, std::vector<cmLocalGenerator *> const &lgs)
 {
-  std::string make = mf->GetRequiredDefinition("CMAKE_MAKE_PROGRAM");
-  std::string compiler = "";
-
   // add all executable and library targets and some of the GLOBAL
   // and UTILITY targets
   for (std::vector<cmLocalGenerator*>::const_iterator lg = lgs.begin();
        lg != lgs.end(); lg++) {
-    cmMakefile* makefile = (*lg)->GetMakefile();
     for (auto &target : (*lg)->GetGeneratorTargets()) {
       std::string targetName = target->GetName();
       switch (target->GetType()) {
@@ -402,18 +612,14 @@ void cmExtraMalterlibGenerator::CollectOutputFilesFromTargets(std::string const
             break;
           }
 
-          this->CollectOutputFilesFromTarget(_ProjectName, *lg, target.get(), make.c_str(),
-                             makefile, compiler.c_str(),
-                             false);
+          this->CollectOutputFilesFromTarget(_Project, *lg, target.get());
           break;
         case cmStateEnums::EXECUTABLE:
         case cmStateEnums::STATIC_LIBRARY:
         case cmStateEnums::SHARED_LIBRARY:
         case cmStateEnums::MODULE_LIBRARY:
         {
-          this->CollectOutputFilesFromTarget(_ProjectName, *lg, target.get(), make.c_str(),
-                             makefile, compiler.c_str(),
-                             false);
+          this->CollectOutputFilesFromTarget(_Project, *lg, target.get());
         } break;
         case cmStateEnums::OBJECT_LIBRARY:
         default:
@@ -423,55 +629,11 @@ void cmExtraMalterlibGenerator::CollectOutputFilesFromTargets(std::string const
   }
 }
 
-void cmExtraMalterlibGenerator::AppendAllTargets(std::string const &_ProjectName,
-  const std::vector<cmLocalGenerator*>& lgs, const cmMakefile* mf,
+void cmExtraMalterlibGenerator::AppendAllTargets(cmMalterlibProjectState &_Project,
   cmMalterlibRegistry& registry)
 {
-  std::string make = mf->GetRequiredDefinition("CMAKE_MAKE_PROGRAM");
-  std::string compiler = "";
-
-  // add all executable and library targets and some of the GLOBAL
-  // and UTILITY targets
-  for (std::vector<cmLocalGenerator*>::const_iterator lg = lgs.begin();
-       lg != lgs.end(); lg++) {
-    cmMakefile* makefile = (*lg)->GetMakefile();
-    for (auto &target : (*lg)->GetGeneratorTargets()) {
-      std::string targetName = target->GetName();
-      switch (target->GetType()) {
-        case cmStateEnums::GLOBAL_TARGET:
-          break;
-        case cmStateEnums::UTILITY:
-        case cmStateEnums::INTERFACE_LIBRARY:
-          // Add all utility targets, except the Nightly/Continuous/
-          // Experimental-"sub"targets as e.g. NightlyStart
-          if (((targetName.find("Nightly") == 0) &&
-               (targetName != "Nightly")) ||
-              ((targetName.find("Continuous") == 0) &&
-               (targetName != "Continuous")) ||
-              ((targetName.find("Experimental") == 0) &&
-               (targetName != "Experimental"))) {
-            break;
-          }
-
-          this->AppendTarget(_ProjectName, registry, *lg, target.get(), make.c_str(),
-                             makefile, compiler.c_str(),
-                             false);
-          break;
-        case cmStateEnums::EXECUTABLE:
-        case cmStateEnums::STATIC_LIBRARY:
-        case cmStateEnums::SHARED_LIBRARY:
-        case cmStateEnums::MODULE_LIBRARY:
-        {
-          this->AppendTarget(_ProjectName, registry, *lg, target.get(), make.c_str(),
-                             makefile, compiler.c_str(),
-                             false);
-        } break;
-        case cmStateEnums::OBJECT_LIBRARY:
-        default:
-          break;
-      }
-    }
-  }
+  for (auto &targetState : _Project.Targets)
+    this->AppendTarget(_Project, registry, targetState);
 }
 
 void cmExtraMalterlibGenerator::GetTargetFiles(
@@ -494,29 +656,57 @@ void cmExtraMalterlibGenerator::GetTargetFiles(
   }
 }
 
-std::string cmExtraMalterlibGenerator::replaceMappedOutputFiles(std::string const &_ProjectName, std::string const &_String, bool _bEvalString)
+std::string cmExtraMalterlibGenerator::replaceMappedOutputFiles(cmMalterlibProjectState &_Project, std::string const &_String, bool _bEvalString)
 {
   std::string OutputString = _String;
 
   if (StringStartsWithPath(_String, tempDir.c_str())) {
-    auto end = MappedOutputFiles[_ProjectName].end();
-    if (auto found = MappedOutputFiles[_ProjectName].find(_String); found != end)
-      cmSystemTools::ReplaceString(OutputString, *found, getMappedOutputFile(_ProjectName, *found, _bEvalString));
+    auto end = _Project.MappedOutputFiles.end();
+    if (auto found = _Project.MappedOutputFiles.find(_String); found != end)
+      cmSystemTools::ReplaceString(OutputString, *found, getMappedOutputFile(_Project, *found, _bEvalString));
     return OutputString;
   }
 
-  for (auto &mapping : MappedOutputFiles[_ProjectName])
-    cmSystemTools::ReplaceString(OutputString, mapping, getMappedOutputFile(_ProjectName, mapping, _bEvalString));
+  if (_Project.MappedOutputMatcher.empty())
+    return OutputString;
+
+  // Every mapped output starts with the temp directory, so only positions
+  // where it occurs are looked up. The longest mapped output wins and
+  // replaced text is not scanned again.
+  OutputString.clear();
+  size_t copied = 0;
+  size_t position = _String.find(tempDir);
+  while (position != std::string::npos) {
+    size_t length = 0;
+    auto match = _Project.MappedOutputMatcher.findLongestPrefix(cm::string_view(_String).substr(position), length);
+    if (match == cmMalterlibPathTrie::NoMatch) {
+      position = _String.find(tempDir, position + 1);
+      continue;
+    }
+
+    auto &mapping = *_Project.MappedOutputMatches[match];
+    OutputString.append(_String, copied, position - copied);
+    if (_bEvalString)
+      OutputString += makeAbsoluteWrapperEvalString(mapping);
+    else
+      OutputString += makeAbsoluteWrapper(mapping);
+    copied = position + length;
+    position = _String.find(tempDir, copied);
+  }
+
+  if (copied == 0)
+    return _String;
 
+  OutputString.append(_String, copied, std::string::npos);
   return OutputString;
 }
 
-std::string cmExtraMalterlibGenerator::getMappedOutputFile(std::string const &_ProjectName, std::string const &_String, bool _bEvalString)
+std::string cmExtraMalterlibGenerator::getMappedOutputFile(cmMalterlibProjectState &_Project, std::string const &_String, bool _bEvalString)
 {
   if (!StringStartsWithPath(_String, tempDir.c_str()))
       return _String;
 
-  if (auto found = MappedOutputFiles[_ProjectName].find(_String); found != MappedOutputFiles[_ProjectName].end())
+  if (auto found = _Project.MappedOutputFiles.find(_String); found != _Project.MappedOutputFiles.end())
   {
     if (_bEvalString)
       return makeAbsoluteWrapperEvalString(_String);
@@ -527,26 +717,57 @@ std::string cmExtraMalterlibGenerator::getMappedOutputFile(std::string const &_P
   return _String;
 }
 
-cmMalterlibRegistry& cmExtraMalterlibGenerator::AddFileInGroup(std::string const &_ProjectName, cmMalterlibRegistry& registry,std::string const &fileName)
+cmMalterlibRegistry& cmExtraMalterlibGenerator::AddFileInGroup(cmMalterlibProjectState &_Project, cmMalterlibRegistry& registry,std::string const &fileName)
 {
+  if (_Project.GroupCacheRegistry != &registry) {
+    _Project.GroupCache.clear();
+    _Project.GroupCacheRegistry = &registry;
+  }
+
+  // The groups only depend on the directory unless a prefix continues into
+  // the file name
+  std::string::size_type directoryLength = fileName.find_last_of("/\\") + 1;
+  std::string directory;
+  bool bCacheGroup = directoryLength > 0 && directoryLength < fileName.size();
+  if (bCacheGroup) {
+    directory = fileName.substr(0, directoryLength);
+    auto cached = _Project.GroupCache.find(directory);
+    if (cached != _Project.GroupCache.end())
+      return AddFileToGroup(_Project, *cached->second, fileName);
+  }
+
+  // Replace the shortest matching prefix, which is the first one in sorted
+  // order
   std::string strippedFileName = fileName;
-  for (auto &prefix : ReplacePrefixes){
-    if (StringStartsWithPath(strippedFileName.c_str(), prefix.first.c_str())) {
-      strippedFileName = prefix.second + strippedFileName.substr(prefix.first.size());
-      break;
-    }
+  std::size_t replaceLength = 0;
+  std::uint32_t replaceIndex = cmMalterlibPathTrie::NoMatch;
+  ReplacePrefixMatcher.visitPrefixes(fileName,
+    [&](std::uint32_t value, std::size_t length) {
+      replaceIndex = value;
+      replaceLength = length;
+      return false;
+    });
+  if (bCacheGroup && ReplacePrefixMatcher.hasLongerKeys(directory))
+    bCacheGroup = false;
+  if (replaceIndex != cmMalterlibPathTrie::NoMatch) {
+    strippedFileName = ReplacePrefixList[replaceIndex].second + fileName.substr(replaceLength);
+    directoryLength = directoryLength + strippedFileName.size() - fileName.size();
   }
 
-  bool bFirstPrefix = true;
+  // Hide the first matching prefix in configuration order. Groups are only
+  // protected when it is the first configured prefix.
+  std::uint32_t hideIndex = cmMalterlibPathTrie::NoMatch;
+  HidePrefixMatcher.visitPrefixes(strippedFileName,
+    [&](std::uint32_t value, std::size_t) {
+      hideIndex = std::min(hideIndex, value);
+      return true;
+    });
+  if (bCacheGroup && HidePrefixMatcher.hasLongerKeys(cm::string_view(strippedFileName).substr(0, directoryLength)))
+    bCacheGroup = false;
   bool bProtectGroups = false;
-  for (auto &prefix : HidePrefixes){
-    if (StringStartsWithPath(strippedFileName.c_str(), prefix.c_str())) {
-      if (bFirstPrefix)
-        bProtectGroups = true;
-      strippedFileName = strippedFileName.substr(prefix.size()+1);
-      break;
-    }
-    bFirstPrefix = false;
+  if (hideIndex != cmMalterlibPathTrie::NoMatch) {
+    bProtectGroups = hideIndex == 0;
+    strippedFileName = strippedFileName.substr(std::min(HidePrefixes[hideIndex].size() + 1, strippedFileName.size()));
   }
 
   std::vector<std::string> components;
@@ -564,19 +785,25 @@ cmMalterlibRegistry& cmExtraMalterlibGenerator::AddFileInGroup(std::string const
       addAtRegistry->Protected = true;
   }
 
-  auto &toReturn = addAtRegistry->addChild("%File", getMappedOutputFile(_ProjectName, fileName, false));
+  if (bCacheGroup)
+    _Project.GroupCache.emplace(std::move(directory), addAtRegistry);
+
+  return AddFileToGroup(_Project, *addAtRegistry, fileName);
+}
+
+cmMalterlibRegistry& cmExtraMalterlibGenerator::AddFileToGroup(cmMalterlibProjectState &_Project, cmMalterlibRegistry& group, std::string const &fileName)
+{
+  auto &toReturn = group.addChild("%File", getMappedOutputFile(_Project, fileName, false));
 
-  if (isDynamic(toReturn.Value))
+  if (isDynamic(toReturn.getValue()))
     toReturn.RawValue = true;
 
   return toReturn;
 }
 
-void cmExtraMalterlibGenerator::CollectOutputFilesFromFiles(std::string const &_ProjectName,
-  std::vector<cmSourceFile*> const &sourceFiles,
+void cmExtraMalterlibGenerator::CollectOutputFilesFromFiles(cmMalterlibProjectState &_Project,
+  cmMalterlibTargetFiles &files,
   std::string const &configName,
-  cmLocalGenerator* lg,
-  const cmGeneratorTarget* target,
   bool isUtilityTarget
 )
 {
@@ -590,29 +817,66 @@ void cmExtraMalterlibGenerator::CollectOutputFilesFromFiles(std::string const &_
 
       if (StringStartsWithPath(Output, tempDir.c_str())) {
         //std::cout << "Adding mapped: " << Output << "\n";
-        MappedOutputFiles[_ProjectName].insert(Output);
-        MappedOutputDirectories[_ProjectName].insert(cmSystemTools::GetFilenamePath(Output));
+        _Project.MappedOutputFiles.insert(Output);
+        _Project.MappedOutputDirectories.insert(cmSystemTools::GetFilenamePath(Output));
       } else {
-        std::cout << "Non mapped output: " << Output << "\n";
+        _Project.Log += "Non mapped output: " + Output + "\n";
       }
     }
   ;
+  cmLocalGenerator *lg = files.LocalGenerator;
   auto *pMakefile = lg->GetMakefile();
-  for (auto &file : sourceFiles)
+  files.CustomCommands.resize(files.SourceFiles.size());
+  for (std::size_t iFile = 0; iFile < files.SourceFiles.size(); ++iFile)
   {
+    cmSourceFile *file = files.SourceFiles[iFile];
     if (!file->GetObjectLibrary().empty())
       continue;
 
     auto *customCommand = file->GetCustomCommand();
 
     std::string fullPath = file->GetFullPath();
+
+    _Project.AddFingerprint("%File");
+    _Project.AddFingerprint(fullPath);
+    _Project.AddFingerprint(file->GetLanguage());
+    if (char const *malterlibLanguage = cmSystemTools::GetEnv("CMAKE_MALTERLIB_LANGUAGE_" + file->GetLanguage()))
+      _Project.AddFingerprint(malterlibLanguage);
+    _Project.AddFingerprint(file->GetIsGenerated() ? "Generated" : "");
+    for (auto &property : file->GetProperties().GetList()) {
+      _Project.AddFingerprint(property.first);
+      _Project.AddFingerprint(property.second);
+    }
+
     if (customCommand)
     {
-      cmCustomCommandGenerator customCommandGenerator(*customCommand, configName, lg);
+      files.CustomCommands[iFile] = cm::make_unique<cmCustomCommandGenerator>(*customCommand, configName, lg);
+      auto &customCommandGenerator = *files.CustomCommands[iFile];
 
       if (customCommandGenerator.GetCC().GetCommandLines().empty())
         continue;
 
+      _Project.AddFingerprint("Custom");
+      _Project.AddFingerprint(cmToCStrSafe(pMakefile->GetProperty("RULE_LAUNCH_CUSTOM")));
+      for (unsigned i = 0; i != customCommandGenerator.GetNumberOfCommands(); ++i) {
+        std::string commandLine = customCommandGenerator.GetCommand(i);
+        customCommandGenerator.AppendArguments(i, commandLine);
+        _Project.AddFingerprint(commandLine);
+      }
+      _Project.AddFingerprint(customCommandGenerator.GetWorkingDirectory());
+      _Project.AddFingerprint(lg->GetCurrentBinaryDirectory());
+      for (auto &output : customCommandGenerator.GetOutputs())
+        _Project.AddFingerprint(output);
+      _Project.AddFingerprint("Byproducts");
+      for (auto &output : customCommandGenerator.GetByproducts())
+        _Project.AddFingerprint(output);
+      _Project.AddFingerprint("Depends");
+      for (auto &dependency : customCommandGenerator.GetDepends()) {
+        std::string realDependency;
+        if (lg->GetRealDependency(dependency, configName, realDependency))
+          _Project.AddFingerprint(realDependency);
+      }
+
 			auto depFile = customCommandGenerator.GetInternalDepfile();
 
 			if (!depFile.empty())
@@ -637,10 +901,33 @@ void cmExtraMalterlibGenerator::CollectOutputFilesFromFiles(std::string const &_
 
       continue;
     }
+
+    if (customCommand || isUtilityTarget || file->GetIsGenerated()
+        || file->GetPropertyAsBool("SYMBOLIC"))
+      continue;
+
+    // The defines are written after evaluating generator expressions, which
+    // can read properties of the target, so hash what is written rather
+    // than the raw values. COMPILE_DEFINITIONS is not part of the property
+    // list above either. Only files that set these pay for the evaluation.
+    bool hasDefines = false;
+    for (std::string const &name : { std::string("COMPILE_DEFINITIONS"),
+           "COMPILE_DEFINITIONS_" + cmSystemTools::UpperCase(configName),
+           std::string("COMPILE_FLAGS") }) {
+      if (file->GetProperty(name))
+        hasDefines = true;
+    }
+    if (hasDefines) {
+      std::set<std::string> defines;
+      AppendFileDefines(defines, lg, files.Target, file, configName);
+      _Project.AddFingerprint("EvaluatedDefines");
+      for (auto &define : defines)
+        _Project.AddFingerprint(define);
+    }
   }
 }
 
-std::string cmExtraMalterlibGenerator::MakeCustomLauncher(std::string const &_ProjectName, cmLocalGenerator *localGenerator, cmCustomCommandGenerator const &ccg)
+std::string cmExtraMalterlibGenerator::MakeCustomLauncher(cmMalterlibProjectState &_Project, cmLocalGenerator *localGenerator, cmCustomCommandGenerator const &ccg)
 {
   cmProp property_value = localGenerator->GetMakefile()->GetProperty("RULE_LAUNCH_CUSTOM");
 
@@ -664,14 +951,14 @@ std::string cmExtraMalterlibGenerator::MakeCustomLauncher(std::string const &_Pr
   std::string launcher = *property_value;
   rulePlaceholderExpander->ExpandRuleVariables(localGenerator, launcher, vars);
   if (!launcher.empty()) {
-    launcher = ConvertCommandParam(_ProjectName, localGenerator, launcher);
+    launcher = ConvertCommandParam(_Project, localGenerator, launcher);
     launcher += " ";
   }
 
   return launcher;
 }
 
-std::string cmExtraMalterlibGenerator::ConvertCommandParam(std::string const &_ProjectName, cmLocalGenerator *localGenerator, std::string const &_String)
+std::string cmExtraMalterlibGenerator::ConvertCommandParam(cmMalterlibProjectState &_Project, cmLocalGenerator *localGenerator, std::string const &_String)
 {
   auto binaryDir = localGenerator->GetBinaryDirectory();
   std::string param = _String;
@@ -679,62 +966,65 @@ std::string cmExtraMalterlibGenerator::ConvertCommandParam(std::string const &_P
   cmSystemTools::ReplaceString(param, "@", "@@");
 
   if (StringStartsWithPath(param, baseDir.c_str()))
-    param = makeAbsoluteWrapperEvalString(replaceMappedOutputFiles(_ProjectName, param, true));
+    param = makeAbsoluteWrapperEvalString(replaceMappedOutputFiles(_Project, param, true));
   else if (StringStartsWithPath(param, binaryDir.c_str()))
-    param = makeAbsoluteWrapperEvalString(replaceMappedOutputFiles(_ProjectName, param, true));
+    param = makeAbsoluteWrapperEvalString(replaceMappedOutputFiles(_Project, param, true));
   else
-    param = replaceMappedOutputFiles(_ProjectName, param, true);
+    param = replaceMappedOutputFiles(_Project, param, true);
 
   return param;
 }
 
-void cmExtraMalterlibGenerator::AddFilesToRegistry(std::string const &_ProjectName,
-  cmMalterlibRegistry& registry,
-  std::vector<cmSourceFile*> const &sourceFiles,
+void cmExtraMalterlibGenerator::ResolveTargets(cmMalterlibProjectState &_Project)
+{
+  for (auto &targetState : _Project.Targets) {
+    ResolveFiles(_Project, targetState.Files, targetState.ConfigName, targetState.IsUtility);
+    for (auto &dependency : targetState.Dependencies) {
+      if (dependency.IsObjectLibrary)
+        ResolveFiles(_Project, dependency.ObjectFiles, targetState.ConfigName, targetState.IsUtility);
+    }
+  }
+}
+
+void cmExtraMalterlibGenerator::ResolveFiles(cmMalterlibProjectState &_Project,
+  cmMalterlibTargetFiles &files,
   std::string const &configName,
-  cmLocalGenerator *lg,
-  const cmGeneratorTarget* target,
   bool isUtilityTarget)
 {
+  cmLocalGenerator *lg = files.LocalGenerator;
+  const cmGeneratorTarget* target = files.Target;
   auto *pMakefile = lg->GetMakefile();
 
-  for (auto &file : sourceFiles) {
+  files.Files.reserve(files.SourceFiles.size());
+  for (std::size_t iFile = 0; iFile < files.SourceFiles.size(); ++iFile) {
+    cmSourceFile *file = files.SourceFiles[iFile];
     if (!file->GetObjectLibrary().empty())
       continue;
 
-    auto *customCommand = file->GetCustomCommand();
-
-    std::string fullPath = file->GetFullPath();
-
-    bool bIsGenerated = file->GetIsGenerated();
+    files.Files.emplace_back();
+    auto &fileState = files.Files.back();
 
-    auto Language = file->GetLanguage();
-
-    std::string malterlibType = getMalterlibCompileType(Language, lg);
+    fileState.FullPath = file->GetFullPath();
+    fileState.IsGenerated = file->GetIsGenerated();
+    fileState.Language = file->GetLanguage();
+    fileState.MalterlibType = getMalterlibCompileType(_Project, fileState.Language, lg);
 
     if (file->GetPropertyAsBool("HEADER_FILE_ONLY"))
-      malterlibType = "Header";
-
-    std::string keys;
-    for (auto &key : file->GetProperties().GetKeys()) {
-      keys += " ";
-      keys += key;
-    }
+      fileState.MalterlibType = "Header";
 
-    if (customCommand) {
-      auto &outFile = AddFileInGroup(_ProjectName, registry, fullPath);
-      cmCustomCommandGenerator customCommandGenerator(*customCommand, configName, lg);
+    if (file->GetCustomCommand()) {
+      fileState.IsCustom = true;
+      auto &customCommandGenerator = *files.CustomCommands[iFile];
 
-      cmMalterlibRegistry *pOutCompile = nullptr;
       {
-        std::string launcher = this->MakeCustomLauncher(_ProjectName, lg, customCommandGenerator);
+        std::string launcher = this->MakeCustomLauncher(_Project, lg, customCommandGenerator);
 
-        std::string commandLines;
+        std::string &commandLines = fileState.CommandLines;
 
         for (unsigned i = 0; i != customCommandGenerator.GetNumberOfCommands(); ++i)
         {
-          auto command = ConvertCommandParam(_ProjectName, lg, customCommandGenerator.GetCommand(i));
-          std::string commandLine = replaceMappedOutputFiles(_ProjectName, launcher, true);
+          auto command = ConvertCommandParam(_Project, lg, customCommandGenerator.GetCommand(i));
+          std::string commandLine = replaceMappedOutputFiles(_Project, launcher, true);
 
           {
             std::string commandValue;
@@ -753,7 +1043,7 @@ void cmExtraMalterlibGenerator::AddFilesToRegistry(std::string const &_ProjectNa
               , commandLine
               , [&](std::string const &_Param, bool &o_bEscape) -> std::string
               {
-                auto toReturn = ConvertCommandParam(_ProjectName, lg, _Param);
+                auto toReturn = ConvertCommandParam(_Project, lg, _Param);
 
                 o_bEscape = !isDynamic(toReturn);
 
@@ -779,67 +1069,125 @@ void cmExtraMalterlibGenerator::AddFilesToRegistry(std::string const &_ProjectNa
 
         if (commandLines.empty())
           continue;
+      }
+
+      fileState.WorkingDirectory = customCommandGenerator.GetWorkingDirectory();
+      if (fileState.WorkingDirectory.empty())
+        fileState.WorkingDirectory = lg->GetCurrentBinaryDirectory();
+
+      for (auto &output : customCommandGenerator.GetOutputs()) {
+
+        if (StringStartsWithPath(output, "/DIR:"))
+          continue;
+
+        bool symbolic = false;
+        if (cmSourceFile *sf = pMakefile->GetSource(output))
+        {
+          if (sf->GetPropertyAsBool("SYMBOLIC"))
+          {
+            symbolic = true;
+            break;
+          }
+        }
 
-        pOutCompile = &outFile.addChild("Compile", "");
+        if (symbolic)
+          continue;
 
-        pOutCompile->addChild("Custom_CommandLine", "`" + commandLines + "`").RawValue = true;
-        pOutCompile->addChild("AllowNonExisting", "true").RawValue = true;
-        if (isUtilityTarget)
-          pOutCompile->addChild("Disabled", "false").RawValue = true;
+        fileState.Outputs.push_back(output);
       }
+      for (auto &output : customCommandGenerator.GetByproducts()) {
+        if (StringStartsWithPath(output, "/DIR:"))
+          continue;
 
-      auto &OutCompile = *pOutCompile;
+        fileState.Outputs.push_back(output);
+      }
 
-      auto WorkingDirectory = customCommandGenerator.GetWorkingDirectory();
+      for (auto &dependency : customCommandGenerator.GetDepends()) {
+        std::string realDependency;
+        if (lg->GetRealDependency(dependency, configName,
+                                  realDependency))
+          fileState.Inputs.push_back(std::move(realDependency));
+      }
+      continue;
+    }
 
-      if (!malterlibType.empty())
-        OutCompile.addChild("Type", malterlibType);
+    fileState.IsSymbolic = file->GetPropertyAsBool("SYMBOLIC");
+    if (fileState.IsSymbolic || isUtilityTarget || fileState.IsGenerated)
+      continue;
 
-      std::string workingDirectory = customCommandGenerator.GetWorkingDirectory();
-      if (workingDirectory.empty())
-        workingDirectory = lg->GetCurrentBinaryDirectory();
+    AppendFileDefines(fileState.Defines, lg, target, file, configName);
+  }
 
-      OutCompile.addChild("Custom_WorkingDirectory", makeAbsoluteWrapper(workingDirectory)).RawValue = true;
+  // The evaluated custom commands are no longer needed.
+  files.CustomCommands.clear();
+}
 
-      std::set<std::string> UsedOutputs;
-      {
-        std::string outputs = "[";
-        size_t index = 0;
-        for (auto &output : customCommandGenerator.GetOutputs()) {
+void cmExtraMalterlibGenerator::AppendFileDefines(std::set<std::string> &defines,
+  cmLocalGenerator *lg,
+  cmGeneratorTarget const *target,
+  cmSourceFile *file,
+  std::string const &configName
+)
+{
+  const std::string config = configName;
+  cmGeneratorExpressionInterpreter genexInterpreter(
+    lg, config, target, file->GetLanguage());
+
+  const std::string COMPILE_DEFINITIONS("COMPILE_DEFINITIONS");
+  if (cmProp compile_defs = file->GetProperty(COMPILE_DEFINITIONS)) {
+    lg->AppendDefines(
+      defines, genexInterpreter.Evaluate(*compile_defs, COMPILE_DEFINITIONS));
+  }
 
-          if (StringStartsWithPath(output, "/DIR:"))
-            continue;
+  std::string defPropName = "COMPILE_DEFINITIONS_";
+  defPropName += cmSystemTools::UpperCase(config);
+  if (cmProp config_compile_defs = file->GetProperty(defPropName)) {
+    lg->AppendDefines(
+      defines,
+      genexInterpreter.Evaluate(*config_compile_defs, COMPILE_DEFINITIONS));
+  }
 
-          bool symbolic = false;
-          if (cmSourceFile *sf = pMakefile->GetSource(output))
-          {
-            if (sf->GetPropertyAsBool("SYMBOLIC"))
-            {
-              symbolic = true;
-              break;
-            }
-          }
+  if (cmProp cflags = file->GetProperty("COMPILE_FLAGS")) {
+    cmGeneratorExpression ge;
+    std::unique_ptr<cmCompiledGeneratorExpression> expression = ge.Parse(*cflags);
+    std::string processed = expression->Evaluate(lg, configName);
+    std::string cStd;
+    ParseCompileFlags(defines, cStd, processed);
+  }
+}
 
-          if (symbolic)
-            continue;
+void cmExtraMalterlibGenerator::AddFilesToRegistry(cmMalterlibProjectState &_Project,
+  cmMalterlibRegistry& registry,
+  cmMalterlibTargetFiles const &files,
+  bool isUtilityTarget)
+{
+  for (auto &fileState : files.Files) {
+    std::string const &fullPath = fileState.FullPath;
+    std::string const &malterlibType = fileState.MalterlibType;
 
-          UsedOutputs.insert(output);
+    if (fileState.IsCustom) {
+      auto &outFile = AddFileInGroup(_Project, registry, fullPath);
 
-          std::string newOutput = getMappedOutputFile(_ProjectName, output, false);
+      if (fileState.CommandLines.empty())
+        continue;
 
-          if (index > 0)
-            outputs += ", ";
-          ++index;
+      auto &OutCompile = outFile.addChild("Compile", "");
 
-          outputs += makeAbsoluteWrapper(newOutput);
-        }
-        for (auto &output : customCommandGenerator.GetByproducts()) {
-          if (StringStartsWithPath(output, "/DIR:"))
-            continue;
+      OutCompile.addChild("Custom_CommandLine", "`" + fileState.CommandLines + "`").RawValue = true;
+      OutCompile.addChild("AllowNonExisting", "true").RawValue = true;
+      if (isUtilityTarget)
+        OutCompile.addChild("Disabled", "false").RawValue = true;
 
-          UsedOutputs.insert(output);
+      if (!malterlibType.empty())
+        OutCompile.addChild("Type", malterlibType);
+
+      OutCompile.addChild("Custom_WorkingDirectory", makeAbsoluteWrapper(fileState.WorkingDirectory)).RawValue = true;
 
-          std::string newOutput = getMappedOutputFile(_ProjectName, output, false);
+      {
+        std::string outputs = "[";
+        size_t index = 0;
+        for (auto &output : fileState.Outputs) {
+          std::string newOutput = getMappedOutputFile(_Project, output, false);
 
           if (index > 0)
             outputs += ", ";
@@ -855,90 +1203,55 @@ void cmExtraMalterlibGenerator::AddFilesToRegistry(std::string const &_ProjectNa
       {
         std::string inputs = "[";
         size_t index = 0;
-        for (auto &dependency : customCommandGenerator.GetDepends()) {
-          std::string realDependency;
-          if (lg->GetRealDependency(dependency, configName,
-                                    realDependency)) {
-            realDependency = getMappedOutputFile(_ProjectName, realDependency, false);
-            if (index == 0)
-              firstInput = realDependency;
-            else
-              inputs += ", ";
+        for (auto &input : fileState.Inputs) {
+          std::string realDependency = getMappedOutputFile(_Project, input, false);
+          if (index == 0)
+            firstInput = realDependency;
+          else
+            inputs += ", ";
 
-            inputs += makeAbsoluteWrapper(realDependency);
-            ++index;
-          }
+          inputs += makeAbsoluteWrapper(realDependency);
+          ++index;
         }
         inputs += "]";
         OutCompile.addChild("Custom_Inputs", inputs).RawValue = true;
       }
 
-      if (!cmSystemTools::FileExists(fullPath) && MappedOutputFiles[_ProjectName].find(fullPath) == MappedOutputFiles[_ProjectName].end())
-      {
-        ProtectedFiles.insert(fullPath);
-        cmGeneratedFileStream fout(fullPath.c_str());
-        fout << firstInput;
-      }
+      if (_Project.MappedOutputFiles.find(fullPath) == _Project.MappedOutputFiles.end())
+        _Project.PlaceholderFiles.emplace_back(fullPath, firstInput);
       continue;
     }
 
-    if (file->GetPropertyAsBool("SYMBOLIC"))
+    if (fileState.IsSymbolic)
         continue;
 
     if (isUtilityTarget)
     {
-      AddFileInGroup(_ProjectName, registry, fullPath);
+      AddFileInGroup(_Project, registry, fullPath);
     }
-    else if (bIsGenerated)
+    else if (fileState.IsGenerated)
     {
-      auto &outFile = AddFileInGroup(_ProjectName, registry, fullPath);
+      auto &outFile = AddFileInGroup(_Project, registry, fullPath);
       outFile.addChild("Compile.AllowNonExisting", "true").RawValue = true;
       if (!malterlibType.empty())
         outFile.addChild("Compile.Type", malterlibType);
     }
     else
     {
-      auto &outFile = AddFileInGroup(_ProjectName, registry, fullPath);
+      auto &outFile = AddFileInGroup(_Project, registry, fullPath);
       if (!malterlibType.empty())
         outFile.addChild("Compile.Type", malterlibType);
-      else if (!Language.empty())
+      else if (!fileState.Language.empty())
         outFile.addChild("Compile.Type", "None");
       else
         outFile.addChild("Compile.Disabled", "true").RawValue = true;
 
-      std::set<std::string> defines;
-      const std::string config = configName;
-      cmGeneratorExpressionInterpreter genexInterpreter(
-        lg, config, target, file->GetLanguage());
-
-      const std::string COMPILE_DEFINITIONS("COMPILE_DEFINITIONS");
-      if (cmProp compile_defs = file->GetProperty(COMPILE_DEFINITIONS)) {
-        lg->AppendDefines(
-          defines, genexInterpreter.Evaluate(*compile_defs, COMPILE_DEFINITIONS));
-      }
-
-      std::string defPropName = "COMPILE_DEFINITIONS_";
-      defPropName += cmSystemTools::UpperCase(config);
-      if (cmProp config_compile_defs = file->GetProperty(defPropName)) {
-        lg->AppendDefines(
-          defines,
-          genexInterpreter.Evaluate(*config_compile_defs, COMPILE_DEFINITIONS));
-      }
-
-      if (cmProp cflags = file->GetProperty("COMPILE_FLAGS")) {
-        cmGeneratorExpression ge;
-        std::unique_ptr<cmCompiledGeneratorExpression> expression = ge.Parse(*cflags);
-        std::string processed = expression->Evaluate(lg, configName);
-        std::string cStd;
-        ParseCompileFlags(defines, cStd, processed);
-      }
-
-      if (!defines.empty()) {
+      if (!fileState.Defines.empty()) {
         std::vector<std::string> newDefines;
 
-        for (auto &define : defines)
+        for (auto &define : fileState.Defines)
         {
-          auto Remapped = replaceMappedOutputFiles(_ProjectName, define, true);
+          auto Remapped = replaceMappedOutputFiles(_Project, define, true);
           if (isDynamic(Remapped))
           {
             std::string Escaped;
@@ -958,10 +1271,7 @@ void cmExtraMalterlibGenerator::AddFilesToRegistry(std::string const &_ProjectNa
   }
 }
 
-void cmExtraMalterlibGenerator::CollectOutputFilesFromTarget(std::string const &_ProjectName, cmLocalGenerator* lg, cmGeneratorTarget* target,
-                  const char* make, const cmMakefile* makefile,
-                  const char* compiler,
-                  bool firstTarget)
+void cmExtraMalterlibGenerator::CollectOutputFilesFromTarget(cmMalterlibProjectState &_Project, cmLocalGenerator* lg, cmGeneratorTarget* target)
 {
   if (target == nullptr)
     return;
@@ -983,17 +1293,37 @@ void cmExtraMalterlibGenerator::CollectOutputFilesFromTarget(std::string const &
 
   if (commonGenerator && !commonGenerator->GetConfigNames().empty()) {
     if (commonGenerator->GetConfigNames().size() > 1)
-      lg->GetMakefile()->IssueMessage(MessageType::FATAL_ERROR,
+      _Project.IssueFatalError(lg->GetMakefile(),
         "Generator only supports one config");
 
     configName = commonGenerator->GetConfigNames()[0];
   }
 
-  std::map<std::string, cmMalterlibCompileTypeInfo> compileTypeInfo;
+  _Project.Targets.emplace_back();
+  auto &targetState = _Project.Targets.back();
+  targetState.LocalGenerator = lg;
+  targetState.Target = target;
+  targetState.ConfigName = configName;
+  targetState.IsUtility = isUtilityTarget;
+
+  auto &compileTypeInfo = targetState.CompileTypeInfo;
+  AddTargetCompileInfo(_Project, compileTypeInfo, target, lg, configName);
 
-  std::vector<cmSourceFile*> sourceFiles;
-  GetTargetFiles(sourceFiles, lg, target, makefile);
-  CollectOutputFilesFromFiles(_ProjectName, sourceFiles, configName, lg, target, isUtilityTarget);
+  targetState.ProjectName = lg->GetProjectName();
+  targetState.Name = GetTargetName(target, targetState.ProjectName);
+  targetState.Type = GetTargetType(target);
+  targetState.BaseFileName = target->GetName();
+  targetState.IsStaticLib = IsStaticLib(target);
+
+  _Project.AddFingerprint("%Target");
+  _Project.AddFingerprint(targetState.Name);
+  _Project.AddFingerprint(targetState.Type);
+  _Project.AddFingerprint(configName);
+
+  targetState.Files.LocalGenerator = lg;
+  targetState.Files.Target = target;
+  GetTargetFiles(targetState.Files.SourceFiles, lg, target, lg->GetMakefile());
+  CollectOutputFilesFromFiles(_Project, targetState.Files, configName, isUtilityTarget);
 
   cmTargetDependSet const& targetDependencies =
     const_cast<cmGlobalGenerator*>(GlobalGenerator)->
@@ -1007,119 +1337,82 @@ void cmExtraMalterlibGenerator::CollectOutputFilesFromTarget(std::string const &
 
     if (dependency->GetType() == cmStateEnums::OBJECT_LIBRARY) {
       if (!isUtilityTarget) {
-        std::vector<cmSourceFile*> sourceFiles;
-        GetTargetFiles(sourceFiles, dependencyLocalGenerator, &*dependency, dependencyLocalGenerator->GetMakefile());
-        CollectOutputFilesFromFiles(_ProjectName, sourceFiles,
-                           configName,
-                           dependencyLocalGenerator,
-                           &*dependency,
-                           isUtilityTarget);
+        targetState.Dependencies.emplace_back();
+        auto &objectLibrary = targetState.Dependencies.back();
+        objectLibrary.Target = dependency;
+        objectLibrary.IsObjectLibrary = true;
+        objectLibrary.ObjectFiles.LocalGenerator = dependencyLocalGenerator;
+        objectLibrary.ObjectFiles.Target = dependency;
+        GetTargetFiles(objectLibrary.ObjectFiles.SourceFiles, dependencyLocalGenerator, &*dependency, dependencyLocalGenerator->GetMakefile());
+        CollectOutputFilesFromFiles(_Project, objectLibrary.ObjectFiles, configName, false);
+        AddTargetCompileInfo(_Project, compileTypeInfo, &*dependency, dependencyLocalGenerator, configName);
       }
       continue;
     }
-  }
-}
-
-void cmExtraMalterlibGenerator::AppendTarget(std::string const &_ProjectName,
-  cmMalterlibRegistry& registry,
-  cmLocalGenerator* lg, cmGeneratorTarget* target, const char* make,
-  const cmMakefile* makefile, const char* /*compiler*/,
-  bool firstTarget)
-{
-  if (target == nullptr)
-    return;
 
+    targetState.Dependencies.emplace_back();
+    auto &targetDependency = targetState.Dependencies.back();
+    targetDependency.Target = dependency;
+    targetDependency.Name = GetTargetName(dependency, dependencyLocalGenerator->GetProjectName());
+    targetDependency.IsStaticLib = IsStaticLib(dependency);
+    targetDependency.IsLink = dependency.IsLink();
 
-  if (!target->IsInBuildSystem())
-    return;
-
-  bool isUtilityTarget = false;
-  if (target->GetType() == cmStateEnums::UTILITY ||
-      target->GetType() == cmStateEnums::INTERFACE_LIBRARY ||
-      target->GetType() == cmStateEnums::GLOBAL_TARGET) {
-    isUtilityTarget = true;
+    _Project.AddFingerprint("%Dependency");
+    _Project.AddFingerprint(targetDependency.Name);
+    _Project.AddFingerprint(dependency.IsLink() ? "Link" : "");
   }
 
-  std::string configName = "Debug";
-
-  cmLocalCommonGenerator *commonGenerator =
-    static_cast<cmLocalCommonGenerator *>(lg);
-
-  if (commonGenerator && !commonGenerator->GetConfigNames().empty()) {
-    if (commonGenerator->GetConfigNames().size() > 1)
-      lg->GetMakefile()->IssueMessage(MessageType::FATAL_ERROR,
-        "Generator only supports one config");
-
-    configName = commonGenerator->GetConfigNames()[0];
+  if (!isUtilityTarget) {
+    for (auto &infoMap : compileTypeInfo) {
+      _Project.AddFingerprint("Compile");
+      _Project.AddFingerprint(infoMap.first);
+      for (auto &include : infoMap.second.Includes)
+        _Project.AddFingerprint(include);
+      _Project.AddFingerprint("Defines");
+      for (auto &define : infoMap.second.Defines)
+        _Project.AddFingerprint(define);
+      _Project.AddFingerprint(infoMap.second.cStd);
+    }
   }
+}
 
-  auto &outputTarget = registry.addChild("%Target", GetTargetName(target, lg->GetProjectName()));
+void cmExtraMalterlibGenerator::AppendTarget(cmMalterlibProjectState &_Project,
+  cmMalterlibRegistry& registry,
+  cmMalterlibTargetState &targetState)
+{
+  bool isUtilityTarget = targetState.IsUtility;
+  std::string const &projectName = targetState.ProjectName;
+
+  auto &outputTarget = registry.addChild("%Target", targetState.Name);
   outputTarget.addChild("Property.MalterlibTargetNameType", "Normal");
   outputTarget.addChild("Compile.AllowNonExisting", "true").RawValue = true;
   if (isUtilityTarget)
     outputTarget.addChild("Compile.Disabled", "true").RawValue = true;
-  auto &group = outputTarget.addChild("Target.Group", "External/" + lg->GetProjectName());
+  auto &group = outputTarget.addChild("Target.Group", "External/" + projectName);
   group.addChild("!!Target.Group", "undefined").RawValue = true;
-  outputTarget.addChild("Target.Type", GetTargetType(target));
-  outputTarget.addChild("Target.BaseName", lg->GetProjectName() + "_" + target->GetName());
-  outputTarget.addChild("Target.BaseFileName", target->GetName());
-
-  std::map<std::string, cmMalterlibCompileTypeInfo> compileTypeInfo;
-  AddTargetCompileInfo(compileTypeInfo, target, lg, configName);
-
-  if (!isUtilityTarget) {
-    AddTargetCompileInfo(compileTypeInfo, target, lg, configName);
-    std::vector<cmSourceFile*> sourceFiles;
-    GetTargetFiles(sourceFiles, lg, target, makefile);
-    AddFilesToRegistry(_ProjectName, outputTarget, sourceFiles, configName, lg, target, false);
-  } else {
-    std::vector<cmSourceFile*> sourceFiles;
-    GetTargetFiles(sourceFiles, lg, target, makefile);
-    AddFilesToRegistry(_ProjectName, outputTarget, sourceFiles, configName, lg, target, true);
-  }
+  outputTarget.addChild("Target.Type", targetState.Type);
+  outputTarget.addChild("Target.BaseName", projectName + "_" + targetState.BaseFileName);
+  outputTarget.addChild("Target.BaseFileName", targetState.BaseFileName);
 
-  auto fAddDependencies = [&](auto &_fAddDependencies, cmGeneratorTarget const *_pTarget, bool _bOnlyObjects, mint _Depth) -> void
-    {
-      cmTargetDependSet const& targetDependencies =
-        const_cast<cmGlobalGenerator*>(GlobalGenerator)->
-        GetTargetDirectDepends(_pTarget);
+  auto &compileTypeInfo = targetState.CompileTypeInfo;
 
-      for (auto &dependency : targetDependencies) {
-        auto dependencyLocalGenerator = dependency->GetLocalGenerator();
-        if (dependency->GetName() == "global_target" || dependency->GetType() == cmStateEnums::INTERFACE_LIBRARY) {
-          continue;
-        }
+  AddFilesToRegistry(_Project, outputTarget, targetState.Files, isUtilityTarget);
 
-        if (dependency->GetType() == cmStateEnums::OBJECT_LIBRARY) {
-          if (!isUtilityTarget) {
-            std::vector<cmSourceFile*> sourceFiles;
-            GetTargetFiles(sourceFiles, dependencyLocalGenerator, &*dependency, dependencyLocalGenerator->GetMakefile());
-            AddFilesToRegistry(_ProjectName, outputTarget,
-                               sourceFiles,
-                               configName,
-                               dependencyLocalGenerator,
-                               &*dependency,
-                               isUtilityTarget);
-            AddTargetCompileInfo(compileTypeInfo, &*dependency, dependencyLocalGenerator, configName);
-          }
-          continue;
-        }
-        if (_bOnlyObjects)
-          continue;
+  for (auto &dependency : targetState.Dependencies) {
+    if (dependency.IsObjectLibrary) {
+      AddFilesToRegistry(_Project, outputTarget, dependency.ObjectFiles, isUtilityTarget);
+      continue;
+    }
 
-        auto &outputDependency =
-          outputTarget.addChild("%Dependency", GetTargetName(dependency, dependency->LocalGenerator->GetProjectName()));
+    auto &outputDependency =
+      outputTarget.addChild("%Dependency", dependency.Name);
 
-        if (!dependency.IsLink())
-          outputDependency.addChild("Dependency.Link", "false").RawValue = true;
-        else if (IsStaticLib(target) && IsStaticLib(dependency)) {
-          outputDependency.addChild("Dependency.Indirect", "true").RawValue = true;
-        }
-      }
+    if (!dependency.IsLink)
+      outputDependency.addChild("Dependency.Link", "false").RawValue = true;
+    else if (targetState.IsStaticLib && dependency.IsStaticLib) {
+      outputDependency.addChild("Dependency.Indirect", "true").RawValue = true;
     }
-  ;
-
-  fAddDependencies(fAddDependencies, target, false, 0);
+  }
 
   if (!isUtilityTarget) {
     for (auto &infoMap : compileTypeInfo) {
@@ -1141,7 +1434,7 @@ void cmExtraMalterlibGenerator::AppendTarget(std::string const &_ProjectName,
           if (!StringStartsWithPath(include, tempDir.c_str()))
             continue;
 
-          if (auto found = MappedOutputDirectories[_ProjectName].find(include); found != MappedOutputDirectories[_ProjectName].end())
+          if (auto found = _Project.MappedOutputDirectories.find(include); found != _Project.MappedOutputDirectories.end())
             NewIncludes.push_back(makeAbsoluteWrapper(include));
         }
 
@@ -1153,7 +1446,7 @@ void cmExtraMalterlibGenerator::AppendTarget(std::string const &_ProjectName,
 
         for (auto &define : info.Defines)
         {
-          auto Remapped = replaceMappedOutputFiles(_ProjectName, define, true);
+          auto Remapped = replaceMappedOutputFiles(_Project, define, true);
           if (isDynamic(Remapped))
           {
             std::string Escaped;
@@ -1178,8 +1471,12 @@ void cmExtraMalterlibGenerator::AppendTarget(std::string const &_ProjectName,
     }
   }
 
-  for (auto &child : outputTarget.Children) {
-    if (child.Key == "%Group")
+  // Pruning relinks groups, so forget the ones resolved for this target
+  _Project.GroupCache.clear();
+  _Project.GroupCacheRegistry = nullptr;
+
+  for (auto &child : outputTarget.children()) {
+    if (child.getKey() == "%Group")
       child.pruneLoneChildren();
   }
 }
@@ -6,14 +6,21 @@
 #include <cmConfigure.h>
 #include "cmCustomCommandGenerator.h"
 
+#include "cmCryptoHash.h"
 #include "cmExternalMakefileProjectGenerator.h"
+#include "cmMalterlibPathTrie.h"
 #include "cmMalterlibRegistry.h"
 
+#include <cm/string_view>
 #include <cmsys/String.hxx>
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 class cmGeneratedFileStream;
@@ -22,6 +29,142 @@ class cmLocalGenerator;
 class cmMakefile;
 class cmSourceFile;
 
+struct cmMalterlibCompileTypeInfo
+{
+  std::vector<std::string> Includes;
+  std::set<std::string> Defines;
+  std::string cStd;
+};
+
+/** \class cmMalterlibFileState
+ * \brief A source file as it is added to the registry
+ *
+ * Everything that needs the local generator or the generator targets is
+ * resolved on the main thread, since they fill caches on first query.
+ */
+struct cmMalterlibFileState
+{
+  std::string FullPath;
+  std::string Language;
+  std::string MalterlibType;
+  bool IsGenerated = false;
+  bool IsSymbolic = false;
+  bool IsCustom = false;
+  // Custom command, empty command lines add the file without a command.
+  std::string CommandLines;
+  std::string WorkingDirectory;
+  std::vector<std::string> Outputs;
+  std::vector<std::string> Inputs;
+  // Compile definitions of the file itself.
+  std::set<std::string> Defines;
+};
+
+/** \class cmMalterlibTargetFiles
+ * \brief Source files of a target with their evaluated custom commands
+ */
+struct cmMalterlibTargetFiles
+{
+  cmLocalGenerator* LocalGenerator = nullptr;
+  cmGeneratorTarget const* Target = nullptr;
+  std::vector<cmSourceFile*> SourceFiles;
+  // Parallel to SourceFiles, null for files without a custom command.
+  std::vector<std::unique_ptr<cmCustomCommandGenerator>> CustomCommands;
+  // The files to add to the registry, once resolved.
+  std::vector<cmMalterlibFileState> Files;
+};
+
+struct cmMalterlibTargetDependency
+{
+  cmGeneratorTarget const* Target = nullptr;
+  std::string Name;
+  bool IsStaticLib = false;
+  bool IsLink = false;
+  // Object libraries are compiled into the depending target.
+  bool IsObjectLibrary = false;
+  cmMalterlibTargetFiles ObjectFiles;
+};
+
+/** \class cmMalterlibTargetState
+ * \brief Everything about a target the project file is generated from
+ *
+ * Filled in when the output files are collected and consumed when the
+ * target is added to the registry, so each target is only walked once.
+ */
+struct cmMalterlibTargetState
+{
+  cmLocalGenerator* LocalGenerator = nullptr;
+  cmGeneratorTarget* Target = nullptr;
+  std::string Name;
+  std::string Type;
+  std::string BaseFileName;
+  std::string ProjectName;
+  std::string ConfigName;
+  bool IsUtility = false;
+  bool IsStaticLib = false;
+  cmMalterlibTargetFiles Files;
+  // In the order of the direct dependencies.
+  std::vector<cmMalterlibTargetDependency> Dependencies;
+  std::map<std::string, cmMalterlibCompileTypeInfo> CompileTypeInfo;
+};
+
+/** \class cmMalterlibProjectState
+ * \brief State owned by the worker processing a single project
+ *
+ * The project is prepared on the main thread, which is everything that
+ * queries the local generators and generator targets.  Its registry is
+ * then built and written on a worker, and everything it produces is kept
+ * here to be merged in project order afterwards.
+ */
+struct cmMalterlibProjectState
+{
+  std::string Name;
+  std::vector<cmLocalGenerator*> const* LocalGenerators = nullptr;
+  std::string FileName;
+  bool UpToDate = false;
+
+  // Targets of the project in generation order.
+  std::vector<cmMalterlibTargetState> Targets;
+
+  std::set<std::string> MappedOutputFiles;
+  std::set<std::string> MappedOutputDirectories;
+
+  // Index over MappedOutputFiles used to rewrite strings in a single pass.
+  cmMalterlibPathTrie MappedOutputMatcher;
+  std::vector<std::string const*> MappedOutputMatches;
+
+  // Group node resolved for each source directory of the target currently
+  // being added to GroupCacheRegistry.
+  cmMalterlibRegistry* GroupCacheRegistry = nullptr;
+  std::unordered_map<std::string, cmMalterlibRegistry*> GroupCache;
+
+  // Placeholder files for custom command outputs, in the order encountered.
+  // They are written when the results are merged.
+  std::vector<std::pair<std::string, std::string>> PlaceholderFiles;
+
+  // Diagnostics are deferred so that they are reported in project order.
+  std::vector<std::pair<cmMakefile*, std::string>> FatalErrors;
+  std::string Log;
+
+  // Hash of everything the project's registry is generated from. When it
+  // matches the one stored next to the .MHeader the project is up to date.
+  std::unique_ptr<cmCryptoHash> Fingerprint;
+  std::string FingerprintHex;
+
+  void IssueFatalError(cmMakefile* makefile, std::string const& message)
+  {
+    std::pair<cmMakefile*, std::string> error(makefile, message);
+    if (std::find(this->FatalErrors.begin(), this->FatalErrors.end(),
+                  error) == this->FatalErrors.end())
+      this->FatalErrors.push_back(std::move(error));
+  }
+
+  void AddFingerprint(cm::string_view value)
+  {
+    this->Fingerprint->Append(value);
+    this->Fingerprint->Append("", 1);
+  }
+};
+
 /** \class cmExtraMalterlibGenerator
  * \brief Write Malterlib build system files for Makefile based projects
  */
@@ -34,70 +177,91 @@ public:
   void Generate() override;
 
 private:
-  void CollectOutputFiles();
-  void CreateProjectFile(std::string const &_ProjectName, const std::vector<cmLocalGenerator*>& lgs);
-
-  void CollectOutputFilesFromTargets(std::string const &_ProjectName, std::vector<cmLocalGenerator *> const &lgs, const cmMakefile *mf);
-  void CollectOutputFilesFromTarget(std::string const &_ProjectName, cmLocalGenerator* lg, cmGeneratorTarget* target,
-                    const char* make, const cmMakefile* makefile,
-                    const char* compiler,
-                    bool firstTarget);
-  void CollectOutputFilesFromFiles(std::string const &_ProjectName, 
-    std::vector<cmSourceFile*> const &sourceFiles,
+  class ProjectJob;
+
+  unsigned int GetThreadCount() const;
+  void PrepareProjects();
+  void PrepareProject(cmMalterlibProjectState &_Project);
+  void WriteProject(cmMalterlibProjectState &_Project);
+  void MergeProjects();
+  void BuildMappedOutputMatcher(cmMalterlibProjectState &_Project);
+  std::string GetProjectFileName(const std::vector<cmLocalGenerator*>& lgs) const;
+  void FinalizeFingerprint(cmMalterlibProjectState &_Project);
+  bool IsProjectUpToDate(cmMalterlibProjectState &_Project, std::string const &filename) const;
+  void WriteFingerprint(cmMalterlibProjectState &_Project, std::string const &filename) const;
+  void CreateProjectFile(cmMalterlibProjectState &_Project, const std::vector<cmLocalGenerator*>& lgs);
+
+  void CollectOutputFilesFromTargets(cmMalterlibProjectState &_Project, std::vector<cmLocalGenerator *> const &lgs);
+  void CollectOutputFilesFromTarget(cmMalterlibProjectState &_Project, cmLocalGenerator* lg, cmGeneratorTarget* target);
+  void CollectOutputFilesFromFiles(cmMalterlibProjectState &_Project,
+    cmMalterlibTargetFiles &files,
+    std::string const &configName,
+    bool isUtilityTarget
+  );
+  void ResolveTargets(cmMalterlibProjectState &_Project);
+  void ResolveFiles(cmMalterlibProjectState &_Project,
+    cmMalterlibTargetFiles &files,
     std::string const &configName,
-    cmLocalGenerator* lg,
-    const cmGeneratorTarget* target,
     bool isUtilityTarget
   );
-  std::string getMappedOutputFile(std::string const &_ProjectName, std::string const &_String, bool _bEvalString);
-  std::string replaceMappedOutputFiles(std::string const &_ProjectName, std::string const &_String, bool _bEvalString);
-  std::string MakeCustomLauncher(std::string const &_ProjectName, cmLocalGenerator *localGenerator, cmCustomCommandGenerator const &ccg);
-  std::string ConvertCommandParam(std::string const &_ProjectName, cmLocalGenerator *localGenerator, std::string const &_String);
+  void AppendFileDefines(std::set<std::string> &defines,
+    cmLocalGenerator *lg,
+    cmGeneratorTarget const *target,
+    cmSourceFile *file,
+    std::string const &configName
+  );
+  std::string getMappedOutputFile(cmMalterlibProjectState &_Project, std::string const &_String, bool _bEvalString);
+  std::string replaceMappedOutputFiles(cmMalterlibProjectState &_Project, std::string const &_String, bool _bEvalString);
+  std::string MakeCustomLauncher(cmMalterlibProjectState &_Project, cmLocalGenerator *localGenerator, cmCustomCommandGenerator const &ccg);
+  std::string ConvertCommandParam(cmMalterlibProjectState &_Project, cmLocalGenerator *localGenerator, std::string const &_String);
 
-  void CreateNewProjectFile(std::string const &_ProjectName, const std::vector<cmLocalGenerator*>& lgs,
+  void CreateNewProjectFile(cmMalterlibProjectState &_Project, const std::vector<cmLocalGenerator*>& lgs,
                             const std::string& filename);
 
-  /** Appends all targets as build systems to the project file and get all
-   * include directories and compiler definitions used.
+  /** Appends all targets collected for the project as build systems to the
+   * project file.
    */
-  void AppendAllTargets(std::string const &_ProjectName, const std::vector<cmLocalGenerator*>& lgs,
-                        const cmMakefile* mf, cmMalterlibRegistry& registry
-                        );
+  void AppendAllTargets(cmMalterlibProjectState &_Project, cmMalterlibRegistry& registry);
   /** Appends the specified target to the generated project file as a Sublime
    *  Text build system.
    */
-  void AppendTarget(std::string const &_ProjectName, cmMalterlibRegistry& registry,
-                    cmLocalGenerator* lg, cmGeneratorTarget* target,
-                    const char* make, const cmMakefile* makefile,
-                    const char* compiler,
-                    bool firstTarget);
+  void AppendTarget(cmMalterlibProjectState &_Project, cmMalterlibRegistry& registry,
+                    cmMalterlibTargetState &targetState);
   
   void GetTargetFiles(
     std::vector<cmSourceFile*> &sourceFiles,
     cmLocalGenerator* lg, const cmGeneratorTarget* target,
     const cmMakefile* makefile);
 
-  void AddFilesToRegistry(std::string const &_ProjectName, 
+  void AddFilesToRegistry(cmMalterlibProjectState &_Project, 
     cmMalterlibRegistry& registry, 
-    std::vector<cmSourceFile*> const &sourceFiles,
-    std::string const &configName,
-    cmLocalGenerator* lg,
-    const cmGeneratorTarget* target,
+    cmMalterlibTargetFiles const &files,
     bool isUtilityTarget
   );
 
-  cmMalterlibRegistry& AddFileInGroup(std::string const &_ProjectName, 
+  cmMalterlibRegistry& AddFileInGroup(cmMalterlibProjectState &_Project, 
     cmMalterlibRegistry& registry, 
     std::string const &fileName
   );
+  cmMalterlibRegistry& AddFileToGroup(cmMalterlibProjectState &_Project,
+    cmMalterlibRegistry& group,
+    std::string const &fileName
+  );
 
   std::string tempDir;
   std::string baseDir;
+  // Also write the path lists in the compact binary format.
+  bool CompactLists = false;
   std::vector<std::string> HidePrefixes;
   std::map<std::string, std::string> ReplacePrefixes;
 
-  std::map<std::string, std::set<std::string>> MappedOutputFiles;
-  std::map<std::string, std::set<std::string>> MappedOutputDirectories;
+  // Prefix indices built from HidePrefixes and ReplacePrefixes. Values are
+  // indices into HidePrefixes and ReplacePrefixList.
+  cmMalterlibPathTrie HidePrefixMatcher;
+  cmMalterlibPathTrie ReplacePrefixMatcher;
+  std::vector<std::pair<std::string, std::string>> ReplacePrefixList;
+
+  std::vector<cmMalterlibProjectState> Projects;
 
   std::set<std::string> ProtectedFiles;
 };
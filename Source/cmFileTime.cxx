@@ -49,3 +49,18 @@ bool cmFileTime::Load(std::string const& fileName)
 #endif
   return true;
 }
+
+void cmFileTime::LoadCurrent()
+{
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  this->Time = static_cast<TimeType>(std::time(nullptr)) * UtPerS;
+#else
+  FILETIME now;
+  GetSystemTimeAsFileTime(&now);
+
+  using uint64 = unsigned long long;
+
+  this->Time = static_cast<TimeType>((uint64(now.dwHighDateTime) << 32) +
+                                     now.dwLowDateTime);
+#endif
+}
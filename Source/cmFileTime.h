@@ -31,6 +31,11 @@ public:
    */
   bool Load(std::string const& fileName);
 
+  /**
+   * @brief Loads the current time, comparable with file times
+   */
+  void LoadCurrent();
+
   /**
    * @brief Return true if this is older than ftm
    */
@@ -153,6 +153,12 @@ public:
    */
   void WriteRaw(std::string const& data);
 
+  /**
+   * Get the name of the temporary file that holds the output written so
+   * far.  It is only valid until the stream is closed.
+   */
+  std::string const& GetTempName() const { return this->TempName; }
+
 private:
   // The original locale of the stream (performs no encoding conversion).
   std::locale OriginalLocale;
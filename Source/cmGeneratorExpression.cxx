@@ -2,8 +2,11 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGeneratorExpression.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 
 #include "cmsys/RegularExpression.hxx"
@@ -13,8 +16,53 @@
 #include "cmGeneratorExpressionEvaluator.h"
 #include "cmGeneratorExpressionLexer.h"
 #include "cmGeneratorExpressionParser.h"
+#include "cmGeneratorTarget.h"
+#include "cmLocalGenerator.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmake.h"
+
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmMakefileProfilingData.h"
+#endif
+
+/** Parsed form of an input string, shared by all compiled expressions with
+ *  the same input.  The evaluators point into Input.  */
+struct cmCompiledGeneratorExpression::ParsedInput
+{
+  explicit ParsedInput(std::string input)
+    : Input(std::move(input))
+  {
+    cmGeneratorExpressionLexer l;
+    std::vector<cmGeneratorExpressionToken> tokens = l.Tokenize(this->Input);
+    this->NeedsEvaluation = l.GetSawGeneratorExpression();
+
+    if (this->NeedsEvaluation) {
+      cmGeneratorExpressionParser p(tokens);
+      p.Parse(this->Evaluators);
+    }
+
+    this->DependsOnlyOnConfig = this->NeedsEvaluation &&
+      std::all_of(
+        this->Evaluators.begin(), this->Evaluators.end(),
+        [](std::unique_ptr<cmGeneratorExpressionEvaluator> const& evaluator) {
+          return evaluator->DependsOnlyOnConfig();
+        });
+  }
+
+  const std::string Input;
+  std::vector<std::unique_ptr<cmGeneratorExpressionEvaluator>> Evaluators;
+  bool NeedsEvaluation;
+  bool DependsOnlyOnConfig;
+
+  // Results by configuration, if DependsOnlyOnConfig.  Guarded by
+  // ParseCacheMutex.
+  std::unordered_map<std::string, std::string> ResultByConfig;
+};
+
+namespace {
+std::mutex ParseCacheMutex;
+}
 
 cmGeneratorExpression::cmGeneratorExpression(cmListFileBacktrace backtrace)
   : Backtrace(std::move(backtrace))
@@ -38,12 +86,50 @@ std::string cmGeneratorExpression::Evaluate(
   cmGeneratorExpressionDAGChecker* dagChecker,
   cmGeneratorTarget const* currentTarget, std::string const& language)
 {
-  if (Find(input) != std::string::npos) {
-    cmCompiledGeneratorExpression cge(cmListFileBacktrace(), std::move(input));
-    return cge.Evaluate(lg, config, headTarget, dagChecker, currentTarget,
-                        language);
+  if (Find(input) == std::string::npos) {
+    return input;
+  }
+
+  cmCompiledGeneratorExpression cge(
+    cmListFileBacktrace(),
+    cmCompiledGeneratorExpression::ParseInput(std::move(input)));
+  cmCompiledGeneratorExpression::ParsedInput& parsed = *cge.Parsed;
+  if (!currentTarget) {
+    currentTarget = headTarget;
+  }
+
+  // $<CONFIG:...> also consults the configuration mapping of imported
+  // targets.
+  bool const memoize = parsed.DependsOnlyOnConfig &&
+    !(currentTarget && currentTarget->IsImported());
+  if (memoize) {
+    std::lock_guard<std::mutex> lock(ParseCacheMutex);
+    auto it = parsed.ResultByConfig.find(config);
+    if (it != parsed.ResultByConfig.end()) {
+#ifndef CMAKE_BOOTSTRAP
+      // Results served from the memo still count as evaluations.
+      if (lg && lg->GetCMakeInstance()->IsProfilingEnabled()) {
+        lg->GetCMakeInstance()
+          ->GetProfilingOutput()
+          .CountGeneratorExpressionEvaluation();
+      }
+#endif
+      return it->second;
+    }
+  }
+
+  cmGeneratorExpressionContext context(lg, config, cge.Quiet, headTarget,
+                                       currentTarget,
+                                       cge.EvaluateForBuildsystem,
+                                       cge.Backtrace, language);
+  std::string result = cge.EvaluateWithContext(context, dagChecker);
+
+  // Errors are reported again on each evaluation.
+  if (memoize && !context.HadError) {
+    std::lock_guard<std::mutex> lock(ParseCacheMutex);
+    parsed.ResultByConfig.emplace(config, result);
   }
-  return input;
+  return result;
 }
 
 const std::string& cmCompiledGeneratorExpression::Evaluate(
@@ -64,13 +150,24 @@ const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
   cmGeneratorExpressionContext& context,
   cmGeneratorExpressionDAGChecker* dagChecker) const
 {
-  if (!this->NeedsEvaluation) {
-    return this->Input;
+  if (!this->Parsed->NeedsEvaluation) {
+    return this->Parsed->Input;
+  }
+
+#ifndef CMAKE_BOOTSTRAP
+  // Expressions depending only on the configuration may be evaluated
+  // without a local generator.
+  if (context.LG) {
+    cmake* cm = context.LG->GetCMakeInstance();
+    if (cm->IsProfilingEnabled()) {
+      cm->GetProfilingOutput().CountGeneratorExpressionEvaluation();
+    }
   }
+#endif
 
   this->Output.clear();
 
-  for (const auto& it : this->Evaluators) {
+  for (const auto& it : this->Parsed->Evaluators) {
     this->Output += it->Evaluate(&context, dagChecker);
 
     this->SeenTargetProperties.insert(context.SeenTargetProperties.cbegin(),
@@ -98,22 +195,55 @@ const std::string& cmCompiledGeneratorExpression::EvaluateWithContext(
 
 cmCompiledGeneratorExpression::cmCompiledGeneratorExpression(
   cmListFileBacktrace backtrace, std::string input)
+  : cmCompiledGeneratorExpression(std::move(backtrace),
+                                  ParseInput(std::move(input)))
+{
+}
+
+cmCompiledGeneratorExpression::cmCompiledGeneratorExpression(
+  cmListFileBacktrace backtrace, std::shared_ptr<ParsedInput> parsed)
   : Backtrace(std::move(backtrace))
-  , Input(std::move(input))
+  , Parsed(std::move(parsed))
   , EvaluateForBuildsystem(false)
   , Quiet(false)
   , HadContextSensitiveCondition(false)
   , HadHeadSensitiveCondition(false)
   , HadLinkLanguageSensitiveCondition(false)
 {
-  cmGeneratorExpressionLexer l;
-  std::vector<cmGeneratorExpressionToken> tokens = l.Tokenize(this->Input);
-  this->NeedsEvaluation = l.GetSawGeneratorExpression();
+}
 
-  if (this->NeedsEvaluation) {
-    cmGeneratorExpressionParser p(tokens);
-    p.Parse(this->Evaluators);
+std::shared_ptr<cmCompiledGeneratorExpression::ParsedInput>
+cmCompiledGeneratorExpression::ParseInput(std::string input)
+{
+  // Plain strings are cheap to lex and far more numerous.
+  if (cmGeneratorExpression::Find(input) == std::string::npos) {
+    return std::make_shared<ParsedInput>(std::move(input));
+  }
+
+  // Inputs are parsed once per process.  The parse does not depend on the
+  // backtrace, which is kept by each compiled expression.
+  static std::unordered_map<std::string, std::shared_ptr<ParsedInput>>
+    parseCache;
+
+  {
+    std::lock_guard<std::mutex> lock(ParseCacheMutex);
+    auto it = parseCache.find(input);
+    if (it != parseCache.end()) {
+      return it->second;
+    }
   }
+
+  // Parse outside the lock; another thread may have inserted the same
+  // input meanwhile, in which case its result is used.
+  auto parsed = std::make_shared<ParsedInput>(input);
+  std::lock_guard<std::mutex> lock(ParseCacheMutex);
+  return parseCache.emplace(std::move(input), std::move(parsed))
+    .first->second;
+}
+
+std::string const& cmCompiledGeneratorExpression::GetInput() const
+{
+  return this->Parsed->Input;
 }
 
 std::string cmGeneratorExpression::StripEmptyListElements(
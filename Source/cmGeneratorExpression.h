@@ -18,7 +18,6 @@ class cmGeneratorTarget;
 class cmLocalGenerator;
 struct cmGeneratorExpressionContext;
 struct cmGeneratorExpressionDAGChecker;
-struct cmGeneratorExpressionEvaluator;
 
 /** \class cmGeneratorExpression
  * \brief Evaluate generate-time query expression syntax.
@@ -117,7 +116,7 @@ public:
     return this->AllTargetsSeen;
   }
 
-  std::string const& GetInput() const { return this->Input; }
+  std::string const& GetInput() const;
 
   cmListFileBacktrace GetBacktrace() const { return this->Backtrace; }
   bool GetHadContextSensitiveCondition() const
@@ -152,15 +151,19 @@ private:
     cmGeneratorExpressionContext& context,
     cmGeneratorExpressionDAGChecker* dagChecker) const;
 
+  struct ParsedInput;
+
   cmCompiledGeneratorExpression(cmListFileBacktrace backtrace,
                                 std::string input);
+  cmCompiledGeneratorExpression(cmListFileBacktrace backtrace,
+                                std::shared_ptr<ParsedInput> parsed);
+
+  static std::shared_ptr<ParsedInput> ParseInput(std::string input);
 
   friend class cmGeneratorExpression;
 
   cmListFileBacktrace Backtrace;
-  std::vector<std::unique_ptr<cmGeneratorExpressionEvaluator>> Evaluators;
-  const std::string Input;
-  bool NeedsEvaluation;
+  std::shared_ptr<ParsedInput> Parsed;
   bool EvaluateForBuildsystem;
   bool Quiet;
 
@@ -21,6 +21,39 @@ std::string GeneratorExpressionContent::GetOriginalExpression() const
   return std::string(this->StartContent, this->ContentLength);
 }
 
+bool GeneratorExpressionContent::DependsOnlyOnConfig() const
+{
+  // The node is only known up front for literal identifiers.
+  std::string identifier;
+  for (const auto& pExprEval : this->IdentifierChildren) {
+    if (pExprEval->GetType() != cmGeneratorExpressionEvaluator::Text) {
+      return false;
+    }
+    identifier += pExprEval->Evaluate(nullptr, nullptr);
+  }
+
+  const cmGeneratorExpressionNode* node =
+    cmGeneratorExpressionNode::GetNode(identifier);
+  if (!node || !node->DependsOnlyOnConfig()) {
+    return false;
+  }
+
+  // Mirrors Evaluate(), which ignores the content of such nodes.
+  if (!node->GeneratesContent() && node->NumExpectedParameters() == 1 &&
+      node->AcceptsArbitraryContentParameter()) {
+    return true;
+  }
+
+  for (const auto& param : this->ParamChildren) {
+    for (const auto& pExprEval : param) {
+      if (!pExprEval->DependsOnlyOnConfig()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 std::string GeneratorExpressionContent::ProcessArbitraryContent(
   const cmGeneratorExpressionNode* node, const std::string& identifier,
   cmGeneratorExpressionContext* context,
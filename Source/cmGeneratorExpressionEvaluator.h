@@ -34,6 +34,10 @@ struct cmGeneratorExpressionEvaluator
 
   virtual std::string Evaluate(cmGeneratorExpressionContext* context,
                                cmGeneratorExpressionDAGChecker*) const = 0;
+
+  /** Whether the result depends on nothing but the configuration, when
+      the current target is not imported.  */
+  virtual bool DependsOnlyOnConfig() const = 0;
 };
 
 using cmGeneratorExpressionEvaluatorVector =
@@ -53,6 +57,8 @@ struct TextContent : public cmGeneratorExpressionEvaluator
     return std::string(this->Content, this->Length);
   }
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   Type GetType() const override
   {
     return cmGeneratorExpressionEvaluator::Text;
@@ -90,6 +96,8 @@ struct GeneratorExpressionContent : public cmGeneratorExpressionEvaluator
   std::string Evaluate(cmGeneratorExpressionContext* context,
                        cmGeneratorExpressionDAGChecker*) const override;
 
+  bool DependsOnlyOnConfig() const override;
+
   std::string GetOriginalExpression() const;
 
   ~GeneratorExpressionContent() override;
@@ -75,6 +75,8 @@ static const struct ZeroNode : public cmGeneratorExpressionNode
 {
   ZeroNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   bool GeneratesContent() const override { return false; }
 
   bool AcceptsArbitraryContentParameter() const override { return true; }
@@ -93,6 +95,8 @@ static const struct OneNode : public cmGeneratorExpressionNode
 {
   OneNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   bool AcceptsArbitraryContentParameter() const override { return true; }
 
   std::string Evaluate(
@@ -121,6 +125,8 @@ struct BooleanOpNode : public cmGeneratorExpressionNode
 
   int NumExpectedParameters() const override { return OneOrMoreParameters; }
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   std::string Evaluate(const std::vector<std::string>& parameters,
                        cmGeneratorExpressionContext* context,
                        const GeneratorExpressionContent* content,
@@ -150,6 +156,8 @@ static const struct NotNode : public cmGeneratorExpressionNode
 {
   NotNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   std::string Evaluate(
     const std::vector<std::string>& parameters,
     cmGeneratorExpressionContext* context,
@@ -170,6 +178,8 @@ static const struct BoolNode : public cmGeneratorExpressionNode
 {
   BoolNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 1; }
 
   std::string Evaluate(
@@ -186,6 +196,8 @@ static const struct IfNode : public cmGeneratorExpressionNode
 {
   IfNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 3; }
 
   std::string Evaluate(const std::vector<std::string>& parameters,
@@ -207,6 +219,8 @@ static const struct StrEqualNode : public cmGeneratorExpressionNode
 {
   StrEqualNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 2; }
 
   std::string Evaluate(
@@ -223,6 +237,8 @@ static const struct EqualNode : public cmGeneratorExpressionNode
 {
   EqualNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 2; }
 
   std::string Evaluate(
@@ -324,6 +340,8 @@ static const struct FilterNode : public cmGeneratorExpressionNode
 {
   FilterNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 3; }
 
   std::string Evaluate(
@@ -370,6 +388,8 @@ static const struct RemoveDuplicatesNode : public cmGeneratorExpressionNode
 {
   RemoveDuplicatesNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 1; }
 
   std::string Evaluate(
@@ -569,6 +589,8 @@ static const struct LowerCaseNode : public cmGeneratorExpressionNode
 {
   LowerCaseNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   bool AcceptsArbitraryContentParameter() const override { return true; }
 
   std::string Evaluate(
@@ -585,6 +607,8 @@ static const struct UpperCaseNode : public cmGeneratorExpressionNode
 {
   UpperCaseNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   bool AcceptsArbitraryContentParameter() const override { return true; }
 
   std::string Evaluate(
@@ -601,6 +625,8 @@ static const struct MakeCIdentifierNode : public cmGeneratorExpressionNode
 {
   MakeCIdentifierNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   bool AcceptsArbitraryContentParameter() const override { return true; }
 
   std::string Evaluate(
@@ -618,6 +644,8 @@ struct CharacterNode : public cmGeneratorExpressionNode
 {
   CharacterNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 0; }
 
   std::string Evaluate(
@@ -819,6 +847,8 @@ struct VersionNode : public cmGeneratorExpressionNode
 {
   VersionNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 2; }
 
   std::string Evaluate(
@@ -866,6 +896,8 @@ static const struct ConfigurationNode : public cmGeneratorExpressionNode
 {
   ConfigurationNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 0; }
 
   std::string Evaluate(
@@ -883,6 +915,8 @@ static const struct ConfigurationTestNode : public cmGeneratorExpressionNode
 {
   ConfigurationTestNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return ZeroOrMoreParameters; }
 
   std::string Evaluate(
@@ -943,6 +977,8 @@ static const struct JoinNode : public cmGeneratorExpressionNode
 {
   JoinNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   int NumExpectedParameters() const override { return 2; }
 
   bool AcceptsArbitraryContentParameter() const override { return true; }
@@ -1582,6 +1618,8 @@ static const struct TargetNameNode : public cmGeneratorExpressionNode
 {
   TargetNameNode() {} // NOLINT(modernize-use-equals-default)
 
+  bool DependsOnlyOnConfig() const override { return true; }
+
   bool GeneratesContent() const override { return true; }
 
   bool AcceptsArbitraryContentParameter() const override { return true; }
@@ -33,6 +33,10 @@ struct cmGeneratorExpressionNode
 
   virtual int NumExpectedParameters() const { return 1; }
 
+  /** Whether the result depends on nothing but the parameters and the
+      configuration, when the current target is not imported.  */
+  virtual bool DependsOnlyOnConfig() const { return false; }
+
   virtual std::string Evaluate(
     const std::vector<std::string>& parameters,
     cmGeneratorExpressionContext* context,
@@ -1767,14 +1767,22 @@ void cmGeneratorTarget::ComputeKindedSources(KindedSources& files,
 {
   // Get the source file paths by string.
   std::vector<BT<std::string>> srcs = this->GetSourceFilePaths(config);
+  std::vector<std::string> names;
+  names.reserve(srcs.size());
+  for (BT<std::string> const& s : srcs) {
+    names.push_back(s.Value);
+  }
+  std::vector<cmSourceFile*> sources =
+    this->Makefile->GetOrCreateSources(names);
 
   cmsys::RegularExpression header_regex(CM_HEADER_REGEX);
   std::vector<cmSourceFile*> badObjLib;
 
   std::set<cmSourceFile*> emitted;
-  for (BT<std::string> const& s : srcs) {
+  for (std::size_t i = 0; i < srcs.size(); ++i) {
+    BT<std::string> const& s = srcs[i];
     // Create each source at most once.
-    cmSourceFile* sf = this->Makefile->GetOrCreateSource(s.Value);
+    cmSourceFile* sf = sources[i];
     if (!emitted.insert(sf).second) {
       continue;
     }
@@ -4740,10 +4748,21 @@ std::string cmGeneratorTarget::GetFullPath(const std::string& config,
                                            cmStateEnums::ArtifactType artifact,
                                            bool realname) const
 {
-  if (this->IsImported()) {
-    return this->Target->ImportedGetFullPath(config, artifact);
+  // Every target linking to this one asks for its path, so cache it
+  // like the output name and directory it is made of.  Like those caches
+  // it is filled without a lock, so targets must be queried from one
+  // thread.  Querying LOCATION while configuring recreates the generator
+  // targets, so a path computed before the output properties are final
+  // is not kept.
+  FullPathKey key(OutputNameKey(config, artifact), realname);
+  auto i = this->FullPathMap.find(key);
+  if (i == this->FullPathMap.end()) {
+    std::string fullPath = this->IsImported()
+      ? this->Target->ImportedGetFullPath(config, artifact)
+      : this->NormalGetFullPath(config, artifact, realname);
+    i = this->FullPathMap.emplace(std::move(key), std::move(fullPath)).first;
   }
-  return this->NormalGetFullPath(config, artifact, realname);
+  return i->second;
 }
 
 std::string cmGeneratorTarget::NormalGetFullPath(
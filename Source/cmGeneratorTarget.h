@@ -1070,6 +1070,9 @@ private:
   using OutputNameKey = std::pair<std::string, cmStateEnums::ArtifactType>;
   using OutputNameMapType = std::map<OutputNameKey, std::string>;
   mutable OutputNameMapType OutputNameMap;
+  using FullPathKey = std::pair<OutputNameKey, bool>;
+  using FullPathMapType = std::map<FullPathKey, std::string>;
+  mutable FullPathMapType FullPathMap;
   mutable std::set<cmLinkItem> UtilityItems;
   cmPolicies::PolicyMap PolicyMap;
   mutable bool PolicyWarnedCMP0022;
@@ -2,16 +2,40 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmGlobVerificationManager.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
+#include <cm/memory>
+
+#include "cmsys/Directory.hxx"
 #include "cmsys/FStream.hxx"
+#include "cmsys/Glob.hxx"
+#include "cmsys/RegularExpression.hxx"
+#include "cmsys/SystemTools.hxx"
 
+#include "cmFileTime.h"
 #include "cmGeneratedFileStream.h"
 #include "cmListFileCache.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmVersion.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include <thread>
+
+#  include <cm3p/json/reader.h>
+#  include <cm3p/json/value.h>
+#  include <cm3p/json/writer.h>
+
+#  include "cmCryptoHash.h"
+#  include "cmWorkerPool.h"
+#endif
+
 bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
 {
   if (this->Cache.empty()) {
@@ -19,9 +43,11 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
   }
 
   std::string scriptFile = cmStrCat(path, "/CMakeFiles");
+  std::string infoFile = scriptFile;
   std::string stampFile = scriptFile;
   cmSystemTools::MakeDirectory(scriptFile);
   scriptFile += "/VerifyGlobs.cmake";
+  infoFile += "/VerifyGlobs.json";
   stampFile += "/cmake.verify_globs";
   cmGeneratedFileStream verifyScriptFile(scriptFile);
   verifyScriptFile.SetCopyIfDifferent(true);
@@ -72,6 +98,13 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
   }
   verifyScriptFile.Close();
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (!this->SaveVerificationInfo(infoFile, stampFile)) {
+    return false;
+  }
+  this->VerifyInfo = infoFile;
+#endif
+
   cmsys::ofstream verifyStampFile(stampFile.c_str());
   if (!verifyStampFile) {
     cmSystemTools::Error("Unable to open verification stamp file for write. " +
@@ -85,9 +118,51 @@ bool cmGlobVerificationManager::SaveVerificationScript(const std::string& path)
   return true;
 }
 
+#if !defined(CMAKE_BOOTSTRAP)
+bool cmGlobVerificationManager::SaveVerificationInfo(
+  std::string const& infoFile, std::string const& stampFile)
+{
+  // The same globs for 'cmake -E cmake_verify_globs'.
+  Json::Value info(Json::objectValue);
+  info["stamp"] = stampFile;
+  Json::Value& globs = info["globs"] = Json::arrayValue;
+  for (auto const& i : this->Cache) {
+    CacheEntryKey const& k = std::get<0>(i);
+    CacheEntryValue const& v = std::get<1>(i);
+    if (!v.Initialized) {
+      continue;
+    }
+
+    Json::Value glob(Json::objectValue);
+    glob["recurse"] = k.Recurse;
+    glob["listDirectories"] = k.ListDirectories;
+    glob["followSymlinks"] = k.FollowSymlinks;
+    glob["relative"] = k.Relative;
+    glob["expression"] = k.Expression;
+    Json::Value& files = glob["files"] = Json::arrayValue;
+    for (const std::string& file : v.Files) {
+      files.append(file);
+    }
+    globs.append(std::move(glob));
+  }
+
+  cmGeneratedFileStream verifyInfoFile(infoFile);
+  verifyInfoFile.SetCopyIfDifferent(true);
+  if (!verifyInfoFile) {
+    cmSystemTools::Error("Unable to open verification info file for save. " +
+                         infoFile);
+    cmSystemTools::ReportLastSystemError("");
+    return false;
+  }
+  Json::StyledStreamWriter().write(verifyInfoFile, info);
+  return true;
+}
+#endif
+
 bool cmGlobVerificationManager::DoWriteVerifyTarget() const
 {
-  return !this->VerifyScript.empty() && !this->VerifyStamp.empty();
+  return !this->VerifyScript.empty() && !this->VerifyInfo.empty() &&
+    !this->VerifyStamp.empty();
 }
 
 bool cmGlobVerificationManager::CacheEntryKey::operator<(
@@ -177,5 +252,420 @@ void cmGlobVerificationManager::Reset()
 {
   this->Cache.clear();
   this->VerifyScript.clear();
+  this->VerifyInfo.clear();
   this->VerifyStamp.clear();
 }
+
+#if !defined(CMAKE_BOOTSTRAP)
+namespace {
+// Directories modified this recently are not recorded because a later
+// change within the file system's time resolution would go unnoticed.
+cmFileTime::TimeType const VerifyStateRacyWindow = 2 * cmFileTime::UtPerS;
+
+char const VerifyStateMagic[] = "CMakeVerifyGlobsState 1";
+
+using DirectoryTimes =
+  std::vector<std::pair<std::string, cmFileTime::TimeType>>;
+
+struct GlobCheck
+{
+  bool Recurse = false;
+  bool ListDirectories = false;
+  bool FollowSymlinks = false;
+  std::string Relative;
+  std::string Expression;
+  std::vector<std::string> Files;
+
+  // Identifies the glob together with its expected result.
+  std::string Key;
+  // Directories the result was verified against in the last run.
+  DirectoryTimes const* Recorded = nullptr;
+  // Directories the result depends on in this run.
+  DirectoryTimes Directories;
+  bool DirectoriesKnown = false;
+  bool Changed = false;
+};
+
+/** Directory information shared by all globs of one verification run.
+ *  Each directory is stat'ed and listed at most once, however many of
+ *  the globs cover it.  */
+class DirectoryCache
+{
+public:
+  struct Entry
+  {
+    std::string Name;
+    bool IsDirectory = false;
+    bool IsSymlink = false;
+  };
+
+  struct Listing
+  {
+    bool TimeKnown = false;
+    cmFileTime::TimeType Time = 0;
+    std::vector<Entry> Entries;
+  };
+
+  bool GetTime(std::string const& dir, cmFileTime::TimeType& time);
+  Listing const& GetListing(std::string const& dir);
+
+private:
+  struct ListingSlot
+  {
+    std::once_flag Once;
+    Listing Value;
+  };
+
+  std::mutex Mutex;
+  std::unordered_map<std::string, std::pair<bool, cmFileTime::TimeType>>
+    Times;
+  std::unordered_map<std::string, std::unique_ptr<ListingSlot>> Listings;
+};
+
+bool DirectoryCache::GetTime(std::string const& dir,
+                             cmFileTime::TimeType& time)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto it = this->Times.find(dir);
+    if (it != this->Times.end()) {
+      time = it->second.second;
+      return it->second.first;
+    }
+  }
+  cmFileTime fileTime;
+  bool const loaded = fileTime.Load(dir);
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  auto const& entry =
+    this->Times.emplace(dir, std::make_pair(loaded, fileTime.GetTime()))
+      .first->second;
+  time = entry.second;
+  return entry.first;
+}
+
+DirectoryCache::Listing const& DirectoryCache::GetListing(
+  std::string const& dir)
+{
+  ListingSlot* slot;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::unique_ptr<ListingSlot>& ptr = this->Listings[dir];
+    if (!ptr) {
+      ptr = cm::make_unique<ListingSlot>();
+    }
+    slot = ptr.get();
+  }
+  std::call_once(slot->Once, [this, &dir, slot]() {
+    Listing& listing = slot->Value;
+    // Take the time before listing so that a change made meanwhile is
+    // seen by the next verification.
+    listing.TimeKnown = this->GetTime(dir, listing.Time);
+    cmsys::Directory directory;
+    if (!directory.Load(dir)) {
+      return;
+    }
+    for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i) {
+      Entry entry;
+      entry.Name = directory.GetFile(i);
+      if (entry.Name == "." || entry.Name == "..") {
+        continue;
+      }
+      std::string const path = cmStrCat(dir, '/', entry.Name);
+      entry.IsDirectory = cmSystemTools::FileIsDirectory(path);
+      entry.IsSymlink = cmSystemTools::FileIsSymlink(path);
+      listing.Entries.push_back(std::move(entry));
+    }
+  });
+  return slot->Value;
+}
+
+// Split the expression the way cmsys::Glob does.  The shared listings can
+// be used when the glob matches one name pattern in the entries of a
+// directory whose path has no wildcards, and it does not follow symlinks.
+bool SplitExpression(GlobCheck const& check, std::string& root,
+                     std::string& pattern)
+{
+  std::string const& expr = check.Expression;
+  if (check.FollowSymlinks || !cmSystemTools::FileIsFullPath(expr) ||
+      expr.find('\\') != std::string::npos) {
+    return false;
+  }
+  std::string::size_type const slash =
+    expr.find_last_of('/', expr.find_first_of("*?["));
+  if (slash == 0 || slash == std::string::npos ||
+      expr.find('/', slash + 1) != std::string::npos ||
+      slash + 1 == expr.size() || expr[slash - 1] == ':') {
+    return false;
+  }
+  root = expr.substr(0, slash);
+  pattern = expr.substr(slash + 1);
+  return true;
+}
+
+// Match the entries of a directory, and of its subdirectories for a
+// recursive glob, like cmsys::Glob does.
+void MatchDirectory(GlobCheck& check, DirectoryCache& cache,
+                    std::string const& dir, cmsys::RegularExpression& regex,
+                    std::vector<std::string>& files)
+{
+  DirectoryCache::Listing const& listing = cache.GetListing(dir);
+  if (listing.TimeKnown) {
+    check.Directories.emplace_back(dir, listing.Time);
+  } else {
+    check.DirectoriesKnown = false;
+  }
+  for (DirectoryCache::Entry const& entry : listing.Entries) {
+    std::string path = cmStrCat(dir, '/', entry.Name);
+    if (entry.IsSymlink) {
+      // The result depends on the link target.
+      check.DirectoriesKnown = false;
+    }
+    if (check.Recurse && entry.IsDirectory && !entry.IsSymlink) {
+      if (check.ListDirectories) {
+        files.push_back(path);
+      }
+      MatchDirectory(check, cache, path, regex, files);
+      continue;
+    }
+    if (!check.Recurse && !check.ListDirectories && entry.IsDirectory) {
+      continue;
+    }
+#if defined(_WIN32) || defined(__APPLE__)
+    if (regex.find(cmSystemTools::LowerCase(entry.Name))) {
+#else
+    if (regex.find(entry.Name)) {
+#endif
+      files.push_back(std::move(path));
+    }
+  }
+}
+
+bool Unchanged(GlobCheck const& check, DirectoryCache& cache)
+{
+  // A directory whose time did not change has the same entries, so the
+  // set of subdirectories to visit did not change either.
+  for (auto const& dir : *check.Recorded) {
+    cmFileTime::TimeType time;
+    if (!cache.GetTime(dir.first, time) || time != dir.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RunCheck(GlobCheck& check, DirectoryCache& cache)
+{
+  if (check.Recorded && Unchanged(check, cache)) {
+    check.Directories = *check.Recorded;
+    check.DirectoriesKnown = true;
+    return;
+  }
+
+  std::vector<std::string> files;
+  std::string root;
+  std::string pattern;
+  if (SplitExpression(check, root, pattern)) {
+    cmsys::RegularExpression regex(cmsys::Glob::PatternToRegex(pattern));
+    check.DirectoriesKnown = true;
+    MatchDirectory(check, cache, root, regex, files);
+    if (!check.Relative.empty()) {
+      for (std::string& file : files) {
+        file = cmsys::SystemTools::RelativePath(check.Relative, file);
+      }
+    }
+  } else {
+    cmsys::Glob g;
+    g.SetRecurse(check.Recurse);
+    if (check.Recurse) {
+      if (check.FollowSymlinks) {
+        g.RecurseThroughSymlinksOn();
+      } else {
+        g.RecurseThroughSymlinksOff();
+      }
+    }
+    g.SetListDirs(check.ListDirectories);
+    g.SetRecurseListDirs(check.ListDirectories);
+    if (!check.Relative.empty()) {
+      g.SetRelative(check.Relative.c_str());
+    }
+    cmsys::Glob::GlobMessages messages;
+    g.FindFiles(check.Expression, &messages);
+    for (cmsys::Glob::Message const& message : messages) {
+      if (message.type == cmsys::Glob::error) {
+        // Let the regeneration report the error.
+        check.Changed = true;
+        return;
+      }
+    }
+    files = std::move(g.GetFiles());
+  }
+
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  check.Changed = files != check.Files;
+}
+
+class CheckJob : public cmWorkerPool::JobT
+{
+public:
+  CheckJob(GlobCheck& check, DirectoryCache& cache)
+    : Check(check)
+    , Cache(cache)
+  {
+  }
+
+private:
+  void Process() override { RunCheck(this->Check, this->Cache); }
+
+  GlobCheck& Check;
+  DirectoryCache& Cache;
+};
+
+class FinishJob : public cmWorkerPool::JobFenceT
+{
+private:
+  void Process() override { this->Pool()->Abort(); }
+};
+
+std::string GetStateFile(std::string const& infoFile)
+{
+  return cmStrCat(cmSystemTools::GetFilenamePath(infoFile),
+                  "/VerifyGlobs.state");
+}
+
+std::unordered_map<std::string, DirectoryTimes> LoadState(
+  std::string const& stateFile)
+{
+  std::unordered_map<std::string, DirectoryTimes> state;
+  cmsys::ifstream fin(stateFile.c_str());
+  std::string line;
+  if (!fin || !cmSystemTools::GetLineFromStream(fin, line) ||
+      line != VerifyStateMagic) {
+    return state;
+  }
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    std::istringstream header(line);
+    std::string key;
+    std::size_t count = 0;
+    if (!(header >> key >> count)) {
+      return {};
+    }
+    DirectoryTimes& times = state[key];
+    for (std::size_t i = 0; i < count; ++i) {
+      cmFileTime::TimeType time = 0;
+      if (!(fin >> time) || fin.get() != ' ' ||
+          !cmSystemTools::GetLineFromStream(fin, line)) {
+        return {};
+      }
+      times.emplace_back(line, time);
+    }
+  }
+  return state;
+}
+
+void SaveState(std::string const& stateFile,
+               std::vector<GlobCheck> const& checks)
+{
+  cmFileTime now;
+  now.LoadCurrent();
+  cmFileTime::TimeType const latest =
+    now.GetTime() - VerifyStateRacyWindow;
+
+  cmGeneratedFileStream fout(stateFile);
+  fout.SetCopyIfDifferent(true);
+  fout << VerifyStateMagic << '\n';
+  for (GlobCheck const& check : checks) {
+    if (check.Changed || !check.DirectoriesKnown ||
+        std::any_of(check.Directories.begin(), check.Directories.end(),
+                    [latest](DirectoryTimes::value_type const& dir) {
+                      return dir.second > latest ||
+                        dir.first.find('\n') != std::string::npos;
+                    })) {
+      continue;
+    }
+    fout << check.Key << ' ' << check.Directories.size() << '\n';
+    for (auto const& dir : check.Directories) {
+      fout << dir.second << ' ' << dir.first << '\n';
+    }
+  }
+}
+}
+
+bool cmGlobVerificationManager::RunVerification(std::string const& infoFile)
+{
+  Json::Value info;
+  {
+    cmsys::ifstream fin(infoFile.c_str(), std::ios::in | std::ios::binary);
+    Json::Reader reader;
+    if (!fin || !reader.parse(fin, info, false) || !info.isObject()) {
+      cmSystemTools::Error(
+        cmStrCat("Unable to read verification info file ", infoFile));
+      return false;
+    }
+  }
+
+  std::vector<GlobCheck> checks;
+  for (Json::Value const& glob : info["globs"]) {
+    GlobCheck check;
+    check.Recurse = glob["recurse"].asBool();
+    check.ListDirectories = glob["listDirectories"].asBool();
+    check.FollowSymlinks = glob["followSymlinks"].asBool();
+    check.Relative = glob["relative"].asString();
+    check.Expression = glob["expression"].asString();
+    check.Key = cmStrCat(check.Recurse ? "GLOB_RECURSE" : "GLOB", '\n',
+                         check.ListDirectories ? "LIST_DIRECTORIES" : "",
+                         '\n', check.FollowSymlinks ? "FOLLOW_SYMLINKS" : "",
+                         '\n', check.Relative, '\n', check.Expression, '\n');
+    for (Json::Value const& file : glob["files"]) {
+      check.Files.push_back(file.asString());
+      check.Key = cmStrCat(check.Key, '\n', check.Files.back());
+    }
+    checks.push_back(std::move(check));
+  }
+  std::string const stampFile = info["stamp"].asString();
+
+  DirectoryCache cache;
+  std::string const stateFile = GetStateFile(infoFile);
+  std::unordered_map<std::string, DirectoryTimes> const state =
+    LoadState(stateFile);
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  for (GlobCheck& check : checks) {
+    check.Key = hasher.HashString(check.Key);
+    auto it = state.find(check.Key);
+    if (it != state.end()) {
+      check.Recorded = &it->second;
+    }
+  }
+
+  unsigned int const threads =
+    std::min(std::max(std::thread::hardware_concurrency(), 1u),
+             static_cast<unsigned int>(checks.size()));
+  if (threads > 1) {
+    cmWorkerPool pool;
+    pool.SetThreadCount(threads);
+    for (GlobCheck& check : checks) {
+      pool.EmplaceJob<CheckJob>(check, cache);
+    }
+    pool.EmplaceJob<FinishJob>();
+    pool.Process();
+  } else {
+    for (GlobCheck& check : checks) {
+      RunCheck(check, cache);
+    }
+  }
+
+  bool changed = false;
+  for (GlobCheck const& check : checks) {
+    if (check.Changed) {
+      std::cerr << "-- GLOB mismatch!\n";
+      changed = true;
+    }
+  }
+  if (changed && !stampFile.empty()) {
+    cmSystemTools::Touch(stampFile, false);
+  }
+
+  SaveState(stateFile, checks);
+  return true;
+}
+#endif
@@ -20,9 +20,21 @@
  */
 class cmGlobVerificationManager
 {
+public:
+#if !defined(CMAKE_BOOTSTRAP)
+  //! Run the globs of an info file written by SaveVerificationScript
+  //! concurrently and touch its stamp file if any result changed.
+  //! Globs whose directories were not modified since the last
+  //! verification are not run again.
+  static bool RunVerification(std::string const& infoFile);
+#endif
+
 protected:
   //! Save verification script for given makefile.
   //! Saves to output <path>/<CMakeFilesDirectory>/VerifyGlobs.cmake
+  //! and, except in bootstrap builds, the same globs to VerifyGlobs.json
+  //! for RunVerification.  The verify target needs that file, so it is
+  //! not written by a bootstrap build.
   bool SaveVerificationScript(const std::string& path);
 
   //! Add an entry into the glob cache
@@ -39,11 +51,17 @@ protected:
   //! Check targets should be written in generated build system.
   bool DoWriteVerifyTarget() const;
 
-  //! Get the paths to the generated script and stamp files
+  //! Get the paths to the generated script, info and stamp files
   std::string const& GetVerifyScript() const { return this->VerifyScript; }
+  std::string const& GetVerifyInfo() const { return this->VerifyInfo; }
   std::string const& GetVerifyStamp() const { return this->VerifyStamp; }
 
 private:
+#if !defined(CMAKE_BOOTSTRAP)
+  bool SaveVerificationInfo(std::string const& infoFile,
+                            std::string const& stampFile);
+#endif
+
   struct CacheEntryKey
   {
     const bool Recurse;
@@ -74,6 +92,7 @@ private:
   using CacheEntryMap = std::map<CacheEntryKey, CacheEntryValue>;
   CacheEntryMap Cache;
   std::string VerifyScript;
+  std::string VerifyInfo;
   std::string VerifyStamp;
 
   // Only cmState should be able to add cache values.
@@ -58,6 +58,7 @@
 #  include <cm3p/json/writer.h>
 
 #  include "cmCryptoHash.h"
+#  include "cmMakefileProfilingData.h"
 #  include "cmQtAutoGenGlobalInitializer.h"
 #endif
 
@@ -1510,6 +1511,11 @@ void cmGlobalGenerator::Generate()
   // Generate project files
   for (unsigned int i = 0; i < this->LocalGenerators.size(); ++i) {
     this->SetCurrentMakefile(this->LocalGenerators[i]->GetMakefile());
+#if !defined(CMAKE_BOOTSTRAP)
+    cmMakefileProfilingData::RAII profilingEntry(
+      this->CMakeInstance, "directory",
+      this->LocalGenerators[i]->GetCurrentBinaryDirectory());
+#endif
     this->LocalGenerators[i]->Generate();
     if (!this->LocalGenerators[i]->GetMakefile()->IsOn(
           "CMAKE_SKIP_INSTALL_RULES")) {
@@ -1544,6 +1550,10 @@ void cmGlobalGenerator::Generate()
   this->WriteSummary();
 
   if (this->ExtraGenerator) {
+#if !defined(CMAKE_BOOTSTRAP)
+    cmMakefileProfilingData::RAII profilingEntry(
+      this->CMakeInstance, "extra-generator", this->ExtraGenerator->GetName());
+#endif
     this->ExtraGenerator->Generate();
   }
 
@@ -1581,6 +1591,10 @@ void cmGlobalGenerator::Generate()
 
 bool cmGlobalGenerator::ComputeTargetDepends()
 {
+#if !defined(CMAKE_BOOTSTRAP)
+  cmMakefileProfilingData::RAII profilingEntry(
+    this->CMakeInstance, "generate", "ComputeTargetDepends");
+#endif
   cmComputeTargetDepends ctd(this);
   if (!ctd.Compute()) {
     return false;
@@ -1638,6 +1652,8 @@ void cmGlobalGenerator::ComputeTargetOrder(cmGeneratorTarget const* gt,
 bool cmGlobalGenerator::QtAutoGen()
 {
 #ifndef CMAKE_BOOTSTRAP
+  cmMakefileProfilingData::RAII profilingEntry(this->CMakeInstance,
+                                               "generate", "QtAutoGen");
   cmQtAutoGenGlobalInitializer initializer(this->LocalGenerators);
   return initializer.generate();
 #else
@@ -1783,6 +1799,10 @@ void cmGlobalGenerator::CreateGeneratorTargets(
 
 void cmGlobalGenerator::CreateGeneratorTargets(TargetTypes targetTypes)
 {
+#if !defined(CMAKE_BOOTSTRAP)
+  cmMakefileProfilingData::RAII profilingEntry(
+    this->CMakeInstance, "generate", "CreateGeneratorTargets");
+#endif
   std::map<cmTarget*, cmGeneratorTarget*> importedMap;
   for (unsigned int i = 0; i < this->Makefiles.size(); ++i) {
     auto& mf = this->Makefiles[i];
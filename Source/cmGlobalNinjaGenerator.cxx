@@ -1760,8 +1760,8 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
     {
       cmNinjaRule rule("VERIFY_GLOBS");
       rule.Command =
-        cmStrCat(this->CMakeCmd(), " -P ",
-                 lg->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
+        cmStrCat(this->CMakeCmd(), " -E cmake_verify_globs ",
+                 lg->ConvertToOutputFormat(cm->GetGlobVerifyInfo(),
                                            cmOutputConverter::SHELL));
       rule.Description = "Re-checking globbed directories...";
       rule.Comment = "Rule for re-checking globbed directories.";
@@ -1791,6 +1791,8 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
     }
     reBuild.Variables.erase("restat");
     reBuild.ImplicitDeps.push_back(verifyScriptFile);
+    reBuild.ImplicitDeps.push_back(
+      this->NinjaOutputPath(cm->GetGlobVerifyInfo()));
     reBuild.ExplicitDeps.push_back(verifyStampFile);
   } else if (!this->SupportsManifestRestat() &&
              cm->DoWriteGlobVerifyTarget()) {
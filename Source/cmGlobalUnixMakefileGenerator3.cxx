@@ -303,6 +303,7 @@ void cmGlobalUnixMakefileGenerator3::WriteMainCMakefile()
   cmake* cm = this->GetCMakeInstance();
   if (cm->DoWriteGlobVerifyTarget()) {
     lfiles.push_back(cm->GetGlobVerifyScript());
+    lfiles.push_back(cm->GetGlobVerifyInfo());
     lfiles.push_back(cm->GetGlobVerifyStamp());
   }
 
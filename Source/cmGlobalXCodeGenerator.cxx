@@ -739,8 +739,8 @@ void cmGlobalXCodeGenerator::CreateReRunCMakeFile(
     makefileStream << "\t"
                    << this->ConvertToRelativeForMake(
                         cmSystemTools::GetCMakeCommand())
-                   << " -P "
-                   << this->ConvertToRelativeForMake(cm->GetGlobVerifyScript())
+                   << " -E cmake_verify_globs "
+                   << this->ConvertToRelativeForMake(cm->GetGlobVerifyInfo())
                    << "\n\n";
   }
 
@@ -2,11 +2,20 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmListFileCache.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <sstream>
 #include <utility>
 
+#include <cm/string_view>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
 #include "cmListFileLexer.h"
 #include "cmMessageType.h"
 #include "cmMessenger.h"
@@ -14,6 +23,7 @@
 #include "cmStateDirectory.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmVersion.h"
 
 struct cmListFileParser
 {
@@ -22,8 +32,10 @@ struct cmListFileParser
   ~cmListFileParser();
   cmListFileParser(const cmListFileParser&) = delete;
   cmListFileParser& operator=(const cmListFileParser&) = delete;
-  void IssueFileOpenError(std::string const& text) const;
-  void IssueError(std::string const& text) const;
+  void IssueMessage(MessageType t, std::string const& text,
+                    cmListFileBacktrace const& lfbt);
+  void IssueFileOpenError(std::string const& text);
+  void IssueError(std::string const& text);
   bool ParseFile(const char* filename);
   bool ParseString(const char* str, const char* virtual_filename);
   bool Parse();
@@ -36,9 +48,10 @@ struct cmListFileParser
   cmMessenger* Messenger;
   const char* FileName;
   cmListFileLexer* Lexer;
+  bool IssuedMessage = false;
   std::string FunctionName;
   long FunctionLine;
-  std::vector<cmListFileArgument> FunctionArguments;
+  cmListFileArgumentBuilder FunctionArguments;
   enum
   {
     SeparationOkay,
@@ -62,20 +75,26 @@ cmListFileParser::~cmListFileParser()
   cmListFileLexer_Delete(this->Lexer);
 }
 
-void cmListFileParser::IssueFileOpenError(const std::string& text) const
+void cmListFileParser::IssueMessage(MessageType t, std::string const& text,
+                                    cmListFileBacktrace const& lfbt)
+{
+  this->IssuedMessage = true;
+  this->Messenger->IssueMessage(t, text, lfbt);
+}
+
+void cmListFileParser::IssueFileOpenError(const std::string& text)
 {
-  this->Messenger->IssueMessage(MessageType::FATAL_ERROR, text,
-                                this->Backtrace);
+  this->IssueMessage(MessageType::FATAL_ERROR, text, this->Backtrace);
 }
 
-void cmListFileParser::IssueError(const std::string& text) const
+void cmListFileParser::IssueError(const std::string& text)
 {
   cmListFileContext lfc;
   lfc.FilePath = this->FileName;
   lfc.Line = cmListFileLexer_GetCurrentLine(this->Lexer);
   cmListFileBacktrace lfbt = this->Backtrace;
   lfbt = lfbt.Push(lfc);
-  this->Messenger->IssueMessage(MessageType::FATAL_ERROR, text, lfbt);
+  this->IssueMessage(MessageType::FATAL_ERROR, text, lfbt);
   cmSystemTools::SetFatalErrorOccured();
 }
 
@@ -138,7 +157,7 @@ bool cmListFileParser::Parse()
         if (this->ParseFunction(token->text, token->line)) {
           this->ListFile->Functions.emplace_back(
             std::move(this->FunctionName), this->FunctionLine,
-            std::move(this->FunctionArguments));
+            this->FunctionArguments.Build());
         } else {
           return false;
         }
@@ -162,10 +181,9 @@ bool cmListFileParser::Parse()
 
   // Check if all functions are nested properly.
   if (auto badNesting = this->CheckNesting()) {
-    this->Messenger->IssueMessage(
-      MessageType::FATAL_ERROR,
-      "Flow control statements are not properly nested.",
-      this->Backtrace.Push(*badNesting));
+    this->IssueMessage(MessageType::FATAL_ERROR,
+                       "Flow control statements are not properly nested.",
+                       this->Backtrace.Push(*badNesting));
     cmSystemTools::SetFatalErrorOccured();
     return false;
   }
@@ -173,19 +191,51 @@ bool cmListFileParser::Parse()
   return true;
 }
 
+std::vector<cmListFileArgument> cmListFileArgumentBuilder::Build()
+{
+  std::vector<cmListFileArgument> arguments;
+  if (this->Arguments.empty()) {
+    return arguments;
+  }
+  // Copy the text to size the shared buffer exactly and keep the capacity
+  // of the builder for the next invocation.
+  auto text = std::make_shared<std::string const>(this->Text);
+  cm::string_view const view = *text;
+  arguments.reserve(this->Arguments.size());
+  for (PendingArgument const& argument : this->Arguments) {
+    arguments.emplace_back(view.substr(argument.Offset, argument.Length),
+                           text, argument.Delim, argument.Line);
+  }
+  this->Text.clear();
+  this->Arguments.clear();
+  return arguments;
+}
+
 bool cmListFile::ParseFile(const char* filename, cmMessenger* messenger,
-                           cmListFileBacktrace const& lfbt)
+                           cmListFileBacktrace const& lfbt,
+                           cmListFileParseCache* cache)
 {
   if (!cmSystemTools::FileExists(filename) ||
       cmSystemTools::FileIsDirectory(filename)) {
     return false;
   }
 
+  cmListFileParseCache::Stamp stamp;
+  if (cache && cache->Find(filename, stamp, this->Functions)) {
+    return true;
+  }
+
   bool parseError = false;
+  bool issuedMessage = false;
 
   {
     cmListFileParser parser(this, lfbt, messenger);
     parseError = !parser.ParseFile(filename);
+    issuedMessage = parser.IssuedMessage;
+  }
+
+  if (cache && !parseError && !issuedMessage) {
+    cache->Insert(filename, stamp, this->Functions);
   }
 
   return !parseError;
@@ -297,14 +347,16 @@ bool cmListFileParser::ParseFunction(const char* name, long line)
   lfbt = lfbt.Push(lfc);
   error << "Parse error.  Function missing ending \")\".  "
         << "End of file reached.";
-  this->Messenger->IssueMessage(MessageType::FATAL_ERROR, error.str(), lfbt);
+  this->IssueMessage(MessageType::FATAL_ERROR, error.str(), lfbt);
   return false;
 }
 
 bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
                                    cmListFileArgument::Delimiter delim)
 {
-  this->FunctionArguments.emplace_back(token->text, delim, token->line);
+  this->FunctionArguments.Add(
+    cm::string_view(token->text, static_cast<std::size_t>(token->length)),
+    delim, token->line);
   if (this->Separation == SeparationOkay) {
     return true;
   }
@@ -322,10 +374,10 @@ bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
     << "Argument not separated from preceding token by whitespace.";
   /* clang-format on */
   if (isError) {
-    this->Messenger->IssueMessage(MessageType::FATAL_ERROR, m.str(), lfbt);
+    this->IssueMessage(MessageType::FATAL_ERROR, m.str(), lfbt);
     return false;
   }
-  this->Messenger->IssueMessage(MessageType::AUTHOR_WARNING, m.str(), lfbt);
+  this->IssueMessage(MessageType::AUTHOR_WARNING, m.str(), lfbt);
   return true;
 }
 
@@ -642,3 +694,198 @@ std::vector<BT<std::string>> ExpandListWithBacktrace(
   }
   return result;
 }
+
+namespace {
+// Files modified this recently are not cached because a later change within
+// the file system's time resolution would go unnoticed.
+cmFileTime::TimeType const ParseCacheRacyWindow = 2 * cmFileTime::UtPerS;
+
+char const ParseCacheMagic[] = "CMakeListFileParseCache 1";
+
+void WriteUInt64(std::string& out, std::uint64_t value)
+{
+  for (int i = 0; i < 8; ++i) {
+    out += static_cast<char>((value >> (i * 8)) & 0xFF);
+  }
+}
+
+void WriteString(std::string& out, cm::string_view value)
+{
+  WriteUInt64(out, value.size());
+  out += value;
+}
+
+struct ParseCacheReader
+{
+  cm::string_view Data;
+  std::size_t Position = 0;
+  bool Ok = true;
+
+  std::uint64_t ReadUInt64()
+  {
+    if (this->Data.size() - this->Position < 8) {
+      this->Ok = false;
+      return 0;
+    }
+    std::uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+      value |= static_cast<std::uint64_t>(
+                 static_cast<unsigned char>(this->Data[this->Position + i]))
+        << (i * 8);
+    }
+    this->Position += 8;
+    return value;
+  }
+
+  cm::string_view ReadView()
+  {
+    std::uint64_t size = this->ReadUInt64();
+    if (!this->Ok || this->Data.size() - this->Position < size) {
+      this->Ok = false;
+      return cm::string_view();
+    }
+    cm::string_view value =
+      this->Data.substr(this->Position, static_cast<std::size_t>(size));
+    this->Position += static_cast<std::size_t>(size);
+    return value;
+  }
+
+  std::string ReadString() { return std::string(this->ReadView()); }
+};
+}
+
+bool cmListFileParseCache::Find(std::string const& path, Stamp& stamp,
+                                std::vector<cmListFileFunction>& functions)
+{
+  cmFileTime fileTime;
+  if (!fileTime.Load(path)) {
+    return false;
+  }
+  stamp.ModifiedTime = fileTime.GetTime();
+  stamp.Size = cmSystemTools::FileLength(path);
+  stamp.Valid = true;
+
+  auto it = this->Entries.find(path);
+  if (it == this->Entries.end() ||
+      it->second.FileStamp.ModifiedTime != stamp.ModifiedTime ||
+      it->second.FileStamp.Size != stamp.Size) {
+    return false;
+  }
+  it->second.Used = true;
+  functions = it->second.Functions;
+  return true;
+}
+
+void cmListFileParseCache::Insert(
+  std::string const& path, Stamp const& stamp,
+  std::vector<cmListFileFunction> const& functions)
+{
+  if (!stamp.Valid) {
+    return;
+  }
+  cmFileTime now;
+  now.LoadCurrent();
+  if (stamp.ModifiedTime > now.GetTime() - ParseCacheRacyWindow) {
+    this->Entries.erase(path);
+    return;
+  }
+  Entry& entry = this->Entries[path];
+  entry.FileStamp = stamp;
+  entry.Functions = functions;
+  entry.Used = true;
+}
+
+bool cmListFileParseCache::Load(std::string const& cacheFile)
+{
+  cmsys::ifstream fin(cacheFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(fin)),
+                   std::istreambuf_iterator<char>());
+
+  ParseCacheReader reader{ data };
+  if (reader.ReadView() != ParseCacheMagic ||
+      reader.ReadView() != cmVersion::GetCMakeVersion()) {
+    return false;
+  }
+
+  std::unordered_map<std::string, Entry> entries;
+  cmListFileArgumentBuilder arguments;
+  std::uint64_t entryCount = reader.ReadUInt64();
+  for (std::uint64_t i = 0; reader.Ok && i < entryCount; ++i) {
+    std::string path = reader.ReadString();
+    Entry entry;
+    entry.FileStamp.ModifiedTime =
+      static_cast<long long>(reader.ReadUInt64());
+    entry.FileStamp.Size = reader.ReadUInt64();
+    entry.FileStamp.Valid = true;
+    std::uint64_t functionCount = reader.ReadUInt64();
+    for (std::uint64_t f = 0; reader.Ok && f < functionCount; ++f) {
+      std::string name = reader.ReadString();
+      auto line = static_cast<long>(reader.ReadUInt64());
+      std::uint64_t argumentCount = reader.ReadUInt64();
+      for (std::uint64_t a = 0; reader.Ok && a < argumentCount; ++a) {
+        cm::string_view value = reader.ReadView();
+        std::uint64_t delim = reader.ReadUInt64();
+        auto argumentLine = static_cast<long>(reader.ReadUInt64());
+        if (delim > cmListFileArgument::Bracket) {
+          reader.Ok = false;
+        }
+        arguments.Add(value, static_cast<cmListFileArgument::Delimiter>(delim),
+                      argumentLine);
+      }
+      entry.Functions.emplace_back(std::move(name), line, arguments.Build());
+    }
+    entries.emplace(std::move(path), std::move(entry));
+  }
+  if (!reader.Ok || reader.Position != data.size()) {
+    return false;
+  }
+
+  // Entries parsed during this run are newer than the loaded ones.
+  for (auto& entry : entries) {
+    this->Entries.emplace(entry.first, std::move(entry.second));
+  }
+  return true;
+}
+
+void cmListFileParseCache::Save(std::string const& cacheFile) const
+{
+  std::vector<std::string const*> paths;
+  for (auto const& entry : this->Entries) {
+    if (entry.second.Used) {
+      paths.push_back(&entry.first);
+    }
+  }
+  std::sort(paths.begin(), paths.end(),
+            [](std::string const* l, std::string const* r) { return *l < *r; });
+
+  std::string data;
+  WriteString(data, ParseCacheMagic);
+  WriteString(data, cmVersion::GetCMakeVersion());
+  WriteUInt64(data, paths.size());
+  for (std::string const* path : paths) {
+    Entry const& entry = this->Entries.at(*path);
+    WriteString(data, *path);
+    WriteUInt64(data,
+                static_cast<std::uint64_t>(entry.FileStamp.ModifiedTime));
+    WriteUInt64(data, entry.FileStamp.Size);
+    WriteUInt64(data, entry.Functions.size());
+    for (cmListFileFunction const& function : entry.Functions) {
+      WriteString(data, function.OriginalName());
+      WriteUInt64(data, static_cast<std::uint64_t>(function.Line()));
+      WriteUInt64(data, function.Arguments().size());
+      for (cmListFileArgument const& argument : function.Arguments()) {
+        WriteString(data, argument.Value);
+        WriteUInt64(data, static_cast<std::uint64_t>(argument.Delim));
+        WriteUInt64(data, static_cast<std::uint64_t>(argument.Line));
+      }
+    }
+  }
+
+  cmGeneratedFileStream fout;
+  fout.Open(cacheFile, true, true);
+  fout.SetCopyIfDifferent(true);
+  fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
@@ -8,10 +8,12 @@
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <cm/optional>
+#include <cm/string_view>
 
 #include "cmStateSnapshot.h"
 #include "cmSystemTools.h"
@@ -47,6 +49,12 @@ struct cmCommandContext
   }
 };
 
+/** \class cmListFileArgument
+ * \brief One argument of a parsed command invocation.
+ *
+ * The argument text is a view into a buffer shared by all arguments of the
+ * same command invocation, see cmListFileArgumentBuilder.
+ */
 struct cmListFileArgument
 {
   enum Delimiter
@@ -56,8 +64,11 @@ struct cmListFileArgument
     Bracket
   };
   cmListFileArgument() = default;
-  cmListFileArgument(std::string v, Delimiter d, long line)
-    : Value(std::move(v))
+  cmListFileArgument(cm::string_view v,
+                     std::shared_ptr<std::string const> buffer, Delimiter d,
+                     long line)
+    : Buffer(std::move(buffer))
+    , Value(v)
     , Delim(d)
     , Line(line)
   {
@@ -67,11 +78,58 @@ struct cmListFileArgument
     return (this->Value == r.Value) && (this->Delim == r.Delim);
   }
   bool operator!=(const cmListFileArgument& r) const { return !(*this == r); }
-  std::string Value;
+
+private:
+  // Keeps the text referenced by Value alive.
+  std::shared_ptr<std::string const> Buffer;
+
+public:
+  cm::string_view Value;
   Delimiter Delim = Unquoted;
   long Line = 0;
 };
 
+/** \class cmListFileArgumentBuilder
+ * \brief Builds the arguments of one command invocation.
+ *
+ * The text of all arguments is copied into one buffer that the built
+ * arguments share.  An invocation thus allocates its text once, however
+ * many arguments it has, and an argument keeps only the text of its own
+ * invocation alive.
+ */
+class cmListFileArgumentBuilder
+{
+public:
+  void Add(cm::string_view value, cmListFileArgument::Delimiter delim,
+           long line)
+  {
+    this->Arguments.push_back({ this->Text.size(), value.size(), delim, line });
+    this->Text.append(value.data(), value.size());
+  }
+
+  //! Make room for the given number of arguments and bytes of text.
+  void Reserve(std::size_t arguments, std::size_t text)
+  {
+    this->Arguments.reserve(arguments);
+    this->Text.reserve(text);
+  }
+
+  //! Create the arguments added so far and reset the builder.
+  std::vector<cmListFileArgument> Build();
+
+private:
+  struct PendingArgument
+  {
+    std::size_t Offset;
+    std::size_t Length;
+    cmListFileArgument::Delimiter Delim;
+    long Line;
+  };
+
+  std::string Text;
+  std::vector<PendingArgument> Arguments;
+};
+
 class cmListFileContext
 {
 public:
@@ -269,13 +327,61 @@ std::vector<BT<std::string>> ExpandListWithBacktrace(
   std::string const& list,
   cmListFileBacktrace const& bt = cmListFileBacktrace());
 
+class cmListFileParseCache;
+
 struct cmListFile
 {
   bool ParseFile(const char* path, cmMessenger* messenger,
-                 cmListFileBacktrace const& lfbt);
+                 cmListFileBacktrace const& lfbt,
+                 cmListFileParseCache* cache = nullptr);
 
   bool ParseString(const char* str, const char* virtual_filename,
                    cmMessenger* messenger, cmListFileBacktrace const& lfbt);
 
   std::vector<cmListFileFunction> Functions;
 };
+
+/** \class cmListFileParseCache
+ * \brief Functions of list files that have already been parsed.
+ *
+ * Entries are keyed by path and are valid as long as the file keeps its
+ * modification time and size.  Only parses that did not issue any
+ * diagnostics are stored, so using an entry is indistinguishable from
+ * parsing the file again.  The cache can be saved to and loaded from disk
+ * to carry it over to the next configure run.
+ */
+class cmListFileParseCache
+{
+public:
+  struct Stamp
+  {
+    long long ModifiedTime = 0;
+    unsigned long long Size = 0;
+    bool Valid = false;
+  };
+
+  /** Loads the stamp of path and, if the cached entry for path still
+   *  matches it, stores the cached functions in functions. */
+  bool Find(std::string const& path, Stamp& stamp,
+            std::vector<cmListFileFunction>& functions);
+
+  /** Caches the functions parsed from path while it had the given stamp.
+   *  Files modified too recently to be told apart from a later change are
+   *  not cached. */
+  void Insert(std::string const& path, Stamp const& stamp,
+              std::vector<cmListFileFunction> const& functions);
+
+  bool Load(std::string const& cacheFile);
+  /** Saves the entries that were used since the cache was loaded. */
+  void Save(std::string const& cacheFile) const;
+
+private:
+  struct Entry
+  {
+    Stamp FileStamp;
+    std::vector<cmListFileFunction> Functions;
+    bool Used = false;
+  };
+
+  std::unordered_map<std::string, Entry> Entries;
+};
@@ -37,6 +37,10 @@
 #include "cmTarget.h"
 #include "cmake.h"
 
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmMakefileProfilingData.h"
+#endif
+
 cmLocalNinjaGenerator::cmLocalNinjaGenerator(cmGlobalGenerator* gg,
                                              cmMakefile* mf)
   : cmLocalCommonGenerator(gg, mf, mf->GetState()->GetBinaryDirectory())
@@ -114,6 +118,10 @@ void cmLocalNinjaGenerator::Generate()
     if (!target->IsInBuildSystem()) {
       continue;
     }
+#if !defined(CMAKE_BOOTSTRAP)
+    cmMakefileProfilingData::RAII profilingEntry(this->GetCMakeInstance(),
+                                                 "target", target->GetName());
+#endif
     auto tg = cmNinjaTargetGenerator::New(target.get());
     if (tg) {
       if (target->Target->IsPerConfig()) {
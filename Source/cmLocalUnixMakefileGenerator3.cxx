@@ -55,6 +55,10 @@
 #  include "cmDependsJava.h"
 #endif
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmMakefileProfilingData.h"
+#endif
+
 namespace {
 // Helper function used below.
 std::string cmSplitExtension(std::string const& in, std::string& base)
@@ -149,6 +153,10 @@ void cmLocalUnixMakefileGenerator3::Generate()
     if (!gt->IsInBuildSystem()) {
       continue;
     }
+#if !defined(CMAKE_BOOTSTRAP)
+    cmMakefileProfilingData::RAII profilingEntry(this->GetCMakeInstance(),
+                                                 "target", gt->GetName());
+#endif
 
     auto& gtVisited = this->GetCommandsVisited(gt);
     const auto& deps = this->GlobalGenerator->GetTargetDirectDepends(gt);
@@ -814,8 +822,8 @@ void cmLocalUnixMakefileGenerator3::WriteSpecialTargetsBottom(
     cmake* cm = this->GlobalGenerator->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
       std::string rescanRule =
-        cmStrCat("$(CMAKE_COMMAND) -P ",
-                 this->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
+        cmStrCat("$(CMAKE_COMMAND) -E cmake_verify_globs ",
+                 this->ConvertToOutputFormat(cm->GetGlobVerifyInfo(),
                                              cmOutputConverter::SHELL));
       commands.push_back(rescanRule);
     }
@@ -1792,8 +1800,8 @@ void cmLocalUnixMakefileGenerator3::WriteLocalAllRules(
     cmake* cm = this->GlobalGenerator->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
       std::string rescanRule =
-        cmStrCat("$(CMAKE_COMMAND) -P ",
-                 this->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
+        cmStrCat("$(CMAKE_COMMAND) -E cmake_verify_globs ",
+                 this->ConvertToOutputFormat(cm->GetGlobVerifyInfo(),
                                              cmOutputConverter::SHELL));
       commands.push_back(rescanRule);
     }
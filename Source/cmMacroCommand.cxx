@@ -2,6 +2,8 @@
    file Copyright.txt or https://cmake.org/licensing for details.  */
 #include "cmMacroCommand.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdio>
 #include <utility>
 
@@ -81,42 +83,56 @@ bool cmMacroHelperCommand::operator()(
     argVs.emplace_back(argvName);
   }
   // Invoke all the functions that were collected in the block.
+  // The replaced arguments of each command share one buffer.
+  cmListFileArgumentBuilder newLFFArgs;
+  {
+    std::size_t maxArgs = 0;
+    std::size_t maxText = 0;
+    for (cmListFileFunction const& func : this->Functions) {
+      std::size_t text = 0;
+      for (cmListFileArgument const& k : func.Arguments()) {
+        text += k.Value.size();
+      }
+      maxArgs = std::max(maxArgs, func.Arguments().size());
+      maxText = std::max(maxText, text);
+    }
+    // Leave some room for the replaced values.
+    newLFFArgs.Reserve(maxArgs, 2 * maxText);
+  }
+  std::string value;
   // for each function
   for (cmListFileFunction const& func : this->Functions) {
     // Replace the formal arguments and then invoke the command.
-    std::vector<cmListFileArgument> newLFFArgs;
-    newLFFArgs.reserve(func.Arguments().size());
 
     // for each argument of the current function
     for (cmListFileArgument const& k : func.Arguments()) {
-      cmListFileArgument arg;
-      arg.Value = k.Value;
-      if (k.Delim != cmListFileArgument::Bracket) {
-        // replace formal arguments
-        for (unsigned int j = 0; j < variables.size(); ++j) {
-          cmSystemTools::ReplaceString(arg.Value, variables[j],
-                                       expandedArgs[j]);
-        }
-        // replace argc
-        cmSystemTools::ReplaceString(arg.Value, "${ARGC}", argcDef);
-
-        cmSystemTools::ReplaceString(arg.Value, "${ARGN}", expandedArgn);
-        cmSystemTools::ReplaceString(arg.Value, "${ARGV}", expandedArgv);
-
-        // if the current argument of the current function has ${ARGV in it
-        // then try replacing ARGV values
-        if (arg.Value.find("${ARGV") != std::string::npos) {
-          for (unsigned int t = 0; t < expandedArgs.size(); ++t) {
-            cmSystemTools::ReplaceString(arg.Value, argVs[t], expandedArgs[t]);
-          }
+      // bracket arguments are never replaced
+      if (k.Delim == cmListFileArgument::Bracket) {
+        newLFFArgs.Add(k.Value, k.Delim, k.Line);
+        continue;
+      }
+      value.assign(k.Value.data(), k.Value.size());
+      // replace formal arguments
+      for (unsigned int j = 0; j < variables.size(); ++j) {
+        cmSystemTools::ReplaceString(value, variables[j], expandedArgs[j]);
+      }
+      // replace argc
+      cmSystemTools::ReplaceString(value, "${ARGC}", argcDef);
+
+      cmSystemTools::ReplaceString(value, "${ARGN}", expandedArgn);
+      cmSystemTools::ReplaceString(value, "${ARGV}", expandedArgv);
+
+      // if the current argument of the current function has ${ARGV in it
+      // then try replacing ARGV values
+      if (value.find("${ARGV") != std::string::npos) {
+        for (unsigned int t = 0; t < expandedArgs.size(); ++t) {
+          cmSystemTools::ReplaceString(value, argVs[t], expandedArgs[t]);
         }
       }
-      arg.Delim = k.Delim;
-      arg.Line = k.Line;
-      newLFFArgs.push_back(std::move(arg));
+      newLFFArgs.Add(value, k.Delim, k.Line);
     }
     cmListFileFunction newLFF{ func.OriginalName(), func.Line(),
-                               std::move(newLFFArgs) };
+                               newLFFArgs.Build() };
     cmExecutionStatus status(makefile);
     if (!makefile.ExecuteCommand(newLFF, status) || status.GetNestedError()) {
       // The error message should have already included the call stack
@@ -304,11 +304,11 @@ void cmMakefile::PrintCommandTrace(
   args.reserve(lff.Arguments().size());
   for (cmListFileArgument const& arg : lff.Arguments()) {
     if (expand && arg.Delim != cmListFileArgument::Bracket) {
-      temp = arg.Value;
+      temp = std::string(arg.Value);
       this->ExpandVariablesInString(temp);
       args.push_back(temp);
     } else {
-      args.push_back(arg.Value);
+      args.emplace_back(arg.Value);
     }
   }
 
@@ -376,8 +376,9 @@ public:
     this->Makefile->ExecutionStatusStack.push_back(&status);
 #if !defined(CMAKE_BOOTSTRAP)
     if (this->Makefile->GetCMakeInstance()->IsProfilingEnabled()) {
-      this->Makefile->GetCMakeInstance()->GetProfilingOutput().StartEntry(lff,
-                                                                          lfc);
+      this->Makefile->GetCMakeInstance()->GetProfilingOutput().StartEntry(
+        lff, lfc,
+        this->Makefile->GetState()->IsScriptedCommand(lff.LowerCaseName()));
     }
 #endif
   }
@@ -624,7 +625,8 @@ bool cmMakefile::ReadDependentFile(const std::string& filename,
 
   cmListFile listFile;
   if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->Backtrace,
+                          this->GetState()->GetListFileParseCache())) {
     return false;
   }
 
@@ -725,7 +727,8 @@ bool cmMakefile::ReadListFile(const std::string& filename)
 
   cmListFile listFile;
   if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->Backtrace,
+                          this->GetState()->GetListFileParseCache())) {
     return false;
   }
 
@@ -1650,7 +1653,8 @@ void cmMakefile::Configure()
 
   cmListFile listFile;
   if (!listFile.ParseFile(currentStart.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->Backtrace,
+                          this->GetState()->GetListFileParseCache())) {
     return;
   }
   if (this->IsRootMakefile()) {
@@ -1721,12 +1725,11 @@ void cmMakefile::Configure()
         "CMake is pretending there is a \"project(Project)\" command on "
         "the first line.",
         this->Backtrace);
-      cmListFileFunction project{ "project",
-                                  0,
-                                  { { "Project", cmListFileArgument::Unquoted,
-                                      0 },
-                                    { "__CMAKE_INJECTED_PROJECT_COMMAND__",
-                                      cmListFileArgument::Unquoted, 0 } } };
+      cmListFileArgumentBuilder projectArgs;
+      projectArgs.Add("Project", cmListFileArgument::Unquoted, 0);
+      projectArgs.Add("__CMAKE_INJECTED_PROJECT_COMMAND__",
+                      cmListFileArgument::Unquoted, 0);
+      cmListFileFunction project{ "project", 0, projectArgs.Build() };
       listFile.Functions.insert(listFile.Functions.begin(), project);
     }
   }
@@ -2581,6 +2584,12 @@ const std::string& cmMakefile::ExpandVariablesInString(
   std::string errorstr;
   std::string original;
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->GetCMakeInstance()->IsProfilingEnabled()) {
+    this->GetCMakeInstance()->GetProfilingOutput().CountVariableExpansion();
+  }
+#endif
+
   // Sanity check the @ONLY mode.
   if (atOnly && (!noEscapes || !removeEmpty)) {
     // This case should never be called.  At-only is for
@@ -3258,11 +3267,11 @@ bool cmMakefile::ExpandArguments(std::vector<cmListFileArgument> const& inArgs,
   for (cmListFileArgument const& i : inArgs) {
     // No expansion in a bracket argument.
     if (i.Delim == cmListFileArgument::Bracket) {
-      outArgs.push_back(i.Value);
+      outArgs.emplace_back(i.Value);
       continue;
     }
     // Expand the variables in the argument.
-    value = i.Value;
+    value.assign(i.Value.data(), i.Value.size());
     this->ExpandVariablesInString(value, false, false, false, filename.c_str(),
                                   i.Line, false, false);
 
@@ -3287,11 +3296,11 @@ bool cmMakefile::ExpandArguments(
   for (cmListFileArgument const& i : inArgs) {
     // No expansion in a bracket argument.
     if (i.Delim == cmListFileArgument::Bracket) {
-      outArgs.emplace_back(i.Value, true);
+      outArgs.emplace_back(std::string(i.Value), true);
       continue;
     }
     // Expand the variables in the argument.
-    value = i.Value;
+    value.assign(i.Value.data(), i.Value.size());
     this->ExpandVariablesInString(value, false, false, false, filename.c_str(),
                                   i.Line, false, false);
 
@@ -3358,23 +3367,20 @@ void cmMakefile::SetArgcArgv(const std::vector<std::string>& args)
   }
 }
 
-cmSourceFile* cmMakefile::GetSource(const std::string& sourceName,
-                                    cmSourceFileLocationKind kind) const
+std::string cmMakefile::GetSourceSearchName(
+  cmSourceFileLocation const& sfl) const
 {
-  // First check "Known" paths (avoids the creation of cmSourceFileLocation)
-  if (kind == cmSourceFileLocationKind::Known) {
-    auto sfsi = this->KnownFileSearchIndex.find(sourceName);
-    if (sfsi != this->KnownFileSearchIndex.end()) {
-      return sfsi->second;
-    }
-  }
-
-  cmSourceFileLocation sfl(this, sourceName, kind);
   auto name = this->GetCMakeInstance()->StripExtension(sfl.GetName());
 #if defined(_WIN32) || defined(__APPLE__)
   name = cmSystemTools::LowerCase(name);
 #endif
-  auto sfsi = this->SourceFileSearchIndex.find(name);
+  return name;
+}
+
+cmSourceFile* cmMakefile::FindSource(cmSourceFileLocation const& sfl,
+                                     std::string const& searchName) const
+{
+  auto sfsi = this->SourceFileSearchIndex.find(searchName);
   if (sfsi != this->SourceFileSearchIndex.end()) {
     for (auto* sf : sfsi->second) {
       if (sf->Matches(sfl)) {
@@ -3385,17 +3391,36 @@ cmSourceFile* cmMakefile::GetSource(const std::string& sourceName,
   return nullptr;
 }
 
+cmSourceFile* cmMakefile::GetSource(const std::string& sourceName,
+                                    cmSourceFileLocationKind kind) const
+{
+  // First check "Known" paths (avoids the creation of cmSourceFileLocation)
+  if (kind == cmSourceFileLocationKind::Known) {
+    auto sfsi = this->KnownFileSearchIndex.find(sourceName);
+    if (sfsi != this->KnownFileSearchIndex.end()) {
+      return sfsi->second;
+    }
+  }
+
+  cmSourceFileLocation sfl(this, sourceName, kind);
+  return this->FindSource(sfl, this->GetSourceSearchName(sfl));
+}
+
 cmSourceFile* cmMakefile::CreateSource(const std::string& sourceName,
                                        bool generated,
                                        cmSourceFileLocationKind kind)
 {
   auto sf = cm::make_unique<cmSourceFile>(this, sourceName, generated, kind);
-  auto name =
-    this->GetCMakeInstance()->StripExtension(sf->GetLocation().GetName());
-#if defined(_WIN32) || defined(__APPLE__)
-  name = cmSystemTools::LowerCase(name);
-#endif
-  this->SourceFileSearchIndex[name].push_back(sf.get());
+  std::string name = this->GetSourceSearchName(sf->GetLocation());
+  return this->AddSourceFile(std::move(sf), name, sourceName, kind);
+}
+
+cmSourceFile* cmMakefile::AddSourceFile(std::unique_ptr<cmSourceFile> sf,
+                                        std::string const& searchName,
+                                        const std::string& sourceName,
+                                        cmSourceFileLocationKind kind)
+{
+  this->SourceFileSearchIndex[searchName].push_back(sf.get());
   // for "Known" paths add direct lookup (used for faster lookup in GetSource)
   if (kind == cmSourceFileLocationKind::Known) {
     this->KnownFileSearchIndex[sourceName] = sf.get();
@@ -3410,10 +3435,63 @@ cmSourceFile* cmMakefile::GetOrCreateSource(const std::string& sourceName,
                                             bool generated,
                                             cmSourceFileLocationKind kind)
 {
-  if (cmSourceFile* esf = this->GetSource(sourceName, kind)) {
+  if (kind == cmSourceFileLocationKind::Known) {
+    auto sfsi = this->KnownFileSearchIndex.find(sourceName);
+    if (sfsi != this->KnownFileSearchIndex.end()) {
+      return sfsi->second;
+    }
+  }
+
+  cmSourceFileLocation sfl(this, sourceName, kind);
+  return this->GetOrCreateSource(sfl, sourceName, generated, kind);
+}
+
+cmSourceFile* cmMakefile::GetOrCreateSource(cmSourceFileLocation const& sfl,
+                                            const std::string& sourceName,
+                                            bool generated,
+                                            cmSourceFileLocationKind kind)
+{
+  // The lookup location is reused for a new source file, so the name is
+  // classified only once.  Generated files always have a known location.
+  std::string searchName = this->GetSourceSearchName(sfl);
+  if (cmSourceFile* esf = this->FindSource(sfl, searchName)) {
     return esf;
   }
-  return this->CreateSource(sourceName, generated, kind);
+  std::unique_ptr<cmSourceFile> sf;
+  if (generated && kind != cmSourceFileLocationKind::Known) {
+    sf = cm::make_unique<cmSourceFile>(this, sourceName, generated, kind);
+  } else {
+    sf = cm::make_unique<cmSourceFile>(sfl, generated);
+  }
+  return this->AddSourceFile(std::move(sf), searchName, sourceName, kind);
+}
+
+std::vector<cmSourceFile*> cmMakefile::GetOrCreateSources(
+  std::vector<std::string> const& sourceNames, cmSourceFileLocationKind kind)
+{
+  std::vector<cmSourceFile*> sources;
+  sources.reserve(sourceNames.size());
+  std::unordered_map<std::string, std::string> directories;
+  for (std::string const& sourceName : sourceNames) {
+    if (kind == cmSourceFileLocationKind::Known) {
+      auto sfsi = this->KnownFileSearchIndex.find(sourceName);
+      if (sfsi != this->KnownFileSearchIndex.end()) {
+        sources.push_back(sfsi->second);
+        continue;
+      }
+    }
+
+    std::string dir = cmSystemTools::GetFilenamePath(sourceName);
+    auto di = directories.find(dir);
+    if (di == directories.end()) {
+      std::string normalized =
+        cmSourceFileLocation::NormalizeDirectory(this, dir, kind);
+      di = directories.emplace(std::move(dir), std::move(normalized)).first;
+    }
+    cmSourceFileLocation sfl(this, sourceName, di->second, kind);
+    sources.push_back(this->GetOrCreateSource(sfl, sourceName, false, kind));
+  }
+  return sources;
 }
 
 cmSourceFile* cmMakefile::GetOrCreateGeneratedSource(
@@ -55,6 +55,7 @@ class cmInstallGenerator;
 class cmLocalGenerator;
 class cmMessenger;
 class cmSourceFile;
+class cmSourceFileLocation;
 class cmState;
 class cmTest;
 class cmTestGenerator;
@@ -469,6 +470,14 @@ public:
     const std::string& sourceName, bool generated = false,
     cmSourceFileLocationKind kind = cmSourceFileLocationKind::Ambiguous);
 
+  /** Get or create the cmSourceFile for each of the given source names, as
+   * GetOrCreateSource does for a single one.  Directories shared by several
+   * names are normalized only once.
+   */
+  std::vector<cmSourceFile*> GetOrCreateSources(
+    std::vector<std::string> const& sourceNames,
+    cmSourceFileLocationKind kind = cmSourceFileLocationKind::Ambiguous);
+
   /** Get a cmSourceFile pointer for a given source name and always mark the
    * file as generated, if the name is not found, then create the source file
    * and return it.
@@ -957,6 +966,18 @@ protected:
   // For "Known" paths we can store a direct filename to cmSourceFile map
   std::unordered_map<std::string, cmSourceFile*> KnownFileSearchIndex;
 
+  std::string GetSourceSearchName(cmSourceFileLocation const& sfl) const;
+  cmSourceFile* FindSource(cmSourceFileLocation const& sfl,
+                           std::string const& searchName) const;
+  cmSourceFile* GetOrCreateSource(cmSourceFileLocation const& sfl,
+                                  const std::string& sourceName,
+                                  bool generated,
+                                  cmSourceFileLocationKind kind);
+  cmSourceFile* AddSourceFile(std::unique_ptr<cmSourceFile> sf,
+                              std::string const& searchName,
+                              const std::string& sourceName,
+                              cmSourceFileLocationKind kind);
+
   // Tests
   std::map<std::string, std::unique_ptr<cmTest>> Tests;
 
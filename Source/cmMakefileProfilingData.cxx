@@ -6,6 +6,8 @@
 #include <stdexcept>
 #include <vector>
 
+#include <cm/memory>
+
 #include <cm3p/json/value.h>
 #include <cm3p/json/writer.h>
 
@@ -13,21 +15,28 @@
 #include "cmsys/SystemInformation.hxx"
 
 #include "cmListFileCache.h"
+#include "cmMakefileProfilingSummary.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmake.h"
 
 cmMakefileProfilingData::cmMakefileProfilingData(
-  const std::string& profileStream)
+  const std::string& profileStream, Format format)
 {
   std::ios::openmode omode = std::ios::out | std::ios::trunc;
   this->ProfileStream.open(profileStream.c_str(), omode);
-  Json::StreamWriterBuilder wbuilder;
-  this->JsonWriter =
-    std::unique_ptr<Json::StreamWriter>(wbuilder.newStreamWriter());
   if (!this->ProfileStream.good()) {
     throw std::runtime_error(std::string("Unable to open: ") + profileStream);
   }
 
+  if (format == Format::Summary) {
+    this->Summary = cm::make_unique<cmMakefileProfilingSummary>();
+    return;
+  }
+
+  Json::StreamWriterBuilder wbuilder;
+  this->JsonWriter =
+    std::unique_ptr<Json::StreamWriter>(wbuilder.newStreamWriter());
   this->ProfileStream << "[";
 };
 
@@ -35,7 +44,11 @@ cmMakefileProfilingData::~cmMakefileProfilingData() noexcept
 {
   if (this->ProfileStream.good()) {
     try {
-      this->ProfileStream << "]";
+      if (this->Summary) {
+        this->Summary->Write(this->ProfileStream);
+      } else {
+        this->ProfileStream << "]";
+      }
       this->ProfileStream.close();
     } catch (...) {
       cmSystemTools::Error("Error writing profiling output!");
@@ -44,13 +57,55 @@ cmMakefileProfilingData::~cmMakefileProfilingData() noexcept
 }
 
 void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
-                                         cmListFileContext const& lfc)
+                                         cmListFileContext const& lfc,
+                                         bool scripted)
 {
+  if (this->Summary) {
+    this->Summary->StartEntry(
+      lff.LowerCaseName(), lfc.FilePath,
+      lff.Arguments().empty() ? std::string()
+                              : std::string(lff.Arguments().front().Value),
+      scripted);
+    return;
+  }
+
+  /* Do not try again if we previously failed to write to output. */
+  if (!this->ProfileStream.good()) {
+    return;
+  }
+
+  Json::Value argsValue;
+  if (!lff.Arguments().empty()) {
+    std::string args;
+    for (auto const& a : lff.Arguments()) {
+      args += (args.empty() ? "" : " ") + std::string(a.Value);
+    }
+    argsValue["functionArgs"] = args;
+  }
+  argsValue["location"] = lfc.FilePath + ":" + std::to_string(lfc.Line);
+  this->WriteBeginEvent("cmake", lff.LowerCaseName(), &argsValue);
+}
+
+void cmMakefileProfilingData::StartEntry(const std::string& category,
+                                         const std::string& name)
+{
+  if (this->Summary) {
+    this->Summary->StartEntry(category, name);
+    return;
+  }
+
   /* Do not try again if we previously failed to write to output. */
   if (!this->ProfileStream.good()) {
     return;
   }
 
+  this->WriteBeginEvent(category, name, nullptr);
+}
+
+void cmMakefileProfilingData::WriteBeginEvent(const std::string& category,
+                                              const std::string& name,
+                                              Json::Value const* args)
+{
   try {
     if (this->ProfileStream.tellp() > 1) {
       this->ProfileStream << ",";
@@ -58,24 +113,17 @@ void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
     cmsys::SystemInformation info;
     Json::Value v;
     v["ph"] = "B";
-    v["name"] = lff.LowerCaseName();
-    v["cat"] = "cmake";
+    v["name"] = name;
+    v["cat"] = category;
     v["ts"] = Json::Value::UInt64(
       std::chrono::duration_cast<std::chrono::microseconds>(
         std::chrono::steady_clock::now().time_since_epoch())
         .count());
     v["pid"] = static_cast<int>(info.GetProcessId());
     v["tid"] = 0;
-    Json::Value argsValue;
-    if (!lff.Arguments().empty()) {
-      std::string args;
-      for (auto const& a : lff.Arguments()) {
-        args += (args.empty() ? "" : " ") + a.Value;
-      }
-      argsValue["functionArgs"] = args;
+    if (args) {
+      v["args"] = *args;
     }
-    argsValue["location"] = lfc.FilePath + ":" + std::to_string(lfc.Line);
-    v["args"] = argsValue;
 
     this->JsonWriter->write(v, &this->ProfileStream);
   } catch (std::ios_base::failure& fail) {
@@ -88,6 +136,11 @@ void cmMakefileProfilingData::StartEntry(const cmListFileFunction& lff,
 
 void cmMakefileProfilingData::StopEntry()
 {
+  if (this->Summary) {
+    this->Summary->StopEntry();
+    return;
+  }
+
   /* Do not try again if we previously failed to write to output. */
   if (!this->ProfileStream.good()) {
     return;
@@ -112,3 +165,33 @@ void cmMakefileProfilingData::StopEntry()
     cmSystemTools::Error("Error writing profiling output!");
   }
 }
+
+void cmMakefileProfilingData::CountVariableExpansion()
+{
+  if (this->Summary) {
+    this->Summary->CountVariableExpansion();
+  }
+}
+
+void cmMakefileProfilingData::CountGeneratorExpressionEvaluation()
+{
+  if (this->Summary) {
+    this->Summary->CountGeneratorExpressionEvaluation();
+  }
+}
+
+cmMakefileProfilingData::RAII::RAII(cmake* cm, const std::string& category,
+                                    const std::string& name)
+  : Data(cm->IsProfilingEnabled() ? &cm->GetProfilingOutput() : nullptr)
+{
+  if (this->Data) {
+    this->Data->StartEntry(category, name);
+  }
+}
+
+cmMakefileProfilingData::RAII::~RAII()
+{
+  if (this->Data) {
+    this->Data->StopEntry();
+  }
+}
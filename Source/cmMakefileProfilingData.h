@@ -8,20 +8,54 @@
 
 namespace Json {
 class StreamWriter;
+class Value;
 }
 
 class cmListFileContext;
 class cmListFileFunction;
+class cmMakefileProfilingSummary;
+class cmake;
 
 class cmMakefileProfilingData
 {
 public:
-  cmMakefileProfilingData(const std::string&);
+  enum class Format
+  {
+    GoogleTrace,
+    Summary
+  };
+
+  cmMakefileProfilingData(const std::string&,
+                          Format format = Format::GoogleTrace);
   ~cmMakefileProfilingData() noexcept;
-  void StartEntry(const cmListFileFunction& lff, cmListFileContext const& lfc);
+  void StartEntry(const cmListFileFunction& lff, cmListFileContext const& lfc,
+                  bool scripted = false);
+  void StartEntry(const std::string& category, const std::string& name);
   void StopEntry();
 
+  /** Record an entry for the lifetime of the object.  Does nothing when
+   *  profiling is not enabled.  */
+  class RAII
+  {
+  public:
+    RAII(cmake* cm, const std::string& category, const std::string& name);
+    ~RAII();
+
+    RAII(RAII const&) = delete;
+    RAII& operator=(RAII const&) = delete;
+
+  private:
+    cmMakefileProfilingData* Data;
+  };
+
+  void CountVariableExpansion();
+  void CountGeneratorExpressionEvaluation();
+
 private:
+  void WriteBeginEvent(const std::string& category, const std::string& name,
+                       Json::Value const* args);
+
   cmsys::ofstream ProfileStream;
   std::unique_ptr<Json::StreamWriter> JsonWriter;
+  std::unique_ptr<cmMakefileProfilingSummary> Summary;
 };
@@ -0,0 +1,151 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#include "cmMakefileProfilingSummary.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+
+#include <cm/string_view>
+#include <cmext/string_view>
+
+#include "cmStringAlgorithms.h"
+
+namespace {
+double Milliseconds(std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration<double, std::milli>(d).count();
+}
+}
+
+cmMakefileProfilingSummary::cmMakefileProfilingSummary()
+  : Start(Clock::now())
+  , MainThread(std::this_thread::get_id())
+  , VariableExpansions(0)
+  , GeneratorExpressionEvaluations(0)
+{
+}
+
+void cmMakefileProfilingSummary::Enter(Frame& frame, Stats& stats)
+{
+  ++stats.Calls;
+  ++stats.Active;
+  frame.Entered.push_back(&stats);
+}
+
+void cmMakefileProfilingSummary::StartEntry(std::string const& name,
+                                            std::string const& file,
+                                            std::string const& firstArgument,
+                                            bool scripted)
+{
+  this->Frames.emplace_back();
+  Frame& frame = this->Frames.back();
+  Enter(frame, this->Commands[name]);
+  if (scripted) {
+    Enter(frame, this->Functions[name]);
+  }
+  Enter(frame, this->Files[file]);
+  if (name == "include"_s || name == "find_package"_s ||
+      name == "add_subdirectory"_s) {
+    this->IncludeChain.push_back(cmStrCat(name, '(', firstArgument, ')'));
+    Enter(frame, this->Includes[cmJoin(this->IncludeChain, " > ")]);
+    frame.Include = true;
+  }
+  frame.Start = Clock::now();
+}
+
+void cmMakefileProfilingSummary::StartEntry(std::string const& category,
+                                            std::string const& name)
+{
+  this->Frames.emplace_back();
+  Frame& frame = this->Frames.back();
+  Enter(frame, this->Steps[cmStrCat(category, ": ", name)]);
+  frame.Start = Clock::now();
+}
+
+void cmMakefileProfilingSummary::StopEntry()
+{
+  if (this->Frames.empty()) {
+    return;
+  }
+  Frame& frame = this->Frames.back();
+  Clock::duration total = Clock::now() - frame.Start;
+  Clock::duration self = total - frame.Children;
+  for (Stats* stats : frame.Entered) {
+    stats->Self += self;
+    stats->VariableExpansions += frame.VariableExpansions;
+    if (--stats->Active == 0) {
+      stats->Total += total;
+    }
+  }
+  if (frame.Include) {
+    this->IncludeChain.pop_back();
+  }
+  this->Frames.pop_back();
+  if (!this->Frames.empty()) {
+    this->Frames.back().Children += total;
+  }
+}
+
+void cmMakefileProfilingSummary::CountVariableExpansion()
+{
+  ++this->VariableExpansions;
+  // Entries are only started on the main thread.
+  if (!this->Frames.empty() &&
+      std::this_thread::get_id() == this->MainThread) {
+    ++this->Frames.back().VariableExpansions;
+  }
+}
+
+void cmMakefileProfilingSummary::CountGeneratorExpressionEvaluation()
+{
+  ++this->GeneratorExpressionEvaluations;
+}
+
+void cmMakefileProfilingSummary::WriteTable(std::ostream& os,
+                                            char const* title,
+                                            StatsMap const& map)
+{
+  using Entry = std::pair<std::string const*, Stats const*>;
+  std::vector<Entry> entries;
+  entries.reserve(map.size());
+  for (auto const& item : map) {
+    entries.emplace_back(&item.first, &item.second);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](Entry const& a, Entry const& b) {
+              if (a.second->Self != b.second->Self) {
+                return a.second->Self > b.second->Self;
+              }
+              return *a.first < *b.first;
+            });
+
+  os << '\n' << title << " (" << entries.size() << ")\n";
+  os << std::setw(12) << "self ms" << std::setw(12) << "total ms"
+     << std::setw(10) << "calls" << std::setw(12) << "expansions"
+     << "  name\n";
+  for (Entry const& e : entries) {
+    os << std::setw(12) << Milliseconds(e.second->Self) << std::setw(12)
+       << Milliseconds(e.second->Total) << std::setw(10) << e.second->Calls
+       << std::setw(12) << e.second->VariableExpansions << "  " << *e.first
+       << '\n';
+  }
+}
+
+void cmMakefileProfilingSummary::Write(std::ostream& os) const
+{
+  std::ios::fmtflags flags = os.flags();
+  os << std::fixed << std::setprecision(3);
+  os << "CMake profiling summary\n";
+  os << "Wall time ms: " << Milliseconds(Clock::now() - this->Start) << '\n';
+  os << "Variable expansions: " << this->VariableExpansions << '\n';
+  os << "Generator expression evaluations: "
+     << this->GeneratorExpressionEvaluations << '\n';
+  WriteTable(os, "Commands", this->Commands);
+  WriteTable(os, "Functions and macros", this->Functions);
+  WriteTable(os, "List files", this->Files);
+  WriteTable(os, "Include chains", this->Includes);
+  WriteTable(os, "Generate steps", this->Steps);
+  os.flags(flags);
+}
@@ -0,0 +1,78 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/** \class cmMakefileProfilingSummary
+ * \brief Aggregates profiling entries into a human readable report.
+ *
+ * Time spent in each entry is accumulated per command, per user defined
+ * function or macro, per list file and per chain of include(),
+ * find_package() and add_subdirectory() calls.  Other entries, such as
+ * the steps of generation, are accumulated by category and name.  Self
+ * time excludes time spent in nested entries; total time of an entry
+ * that recurses into itself is only counted for its outermost call.
+ */
+class cmMakefileProfilingSummary
+{
+public:
+  cmMakefileProfilingSummary();
+
+  void StartEntry(std::string const& name, std::string const& file,
+                  std::string const& firstArgument, bool scripted);
+  void StartEntry(std::string const& category, std::string const& name);
+  void StopEntry();
+
+  //! May be called from any thread.
+  void CountVariableExpansion();
+  //! May be called from any thread.
+  void CountGeneratorExpressionEvaluation();
+
+  void Write(std::ostream& os) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stats
+  {
+    std::uint64_t Calls = 0;
+    Clock::duration Total = Clock::duration::zero();
+    Clock::duration Self = Clock::duration::zero();
+    std::uint64_t VariableExpansions = 0;
+    unsigned int Active = 0;
+  };
+  using StatsMap = std::unordered_map<std::string, Stats>;
+
+  struct Frame
+  {
+    Clock::time_point Start;
+    Clock::duration Children = Clock::duration::zero();
+    std::uint64_t VariableExpansions = 0;
+    std::vector<Stats*> Entered;
+    bool Include = false;
+  };
+
+  static void Enter(Frame& frame, Stats& stats);
+  static void WriteTable(std::ostream& os, char const* title,
+                         StatsMap const& map);
+
+  Clock::time_point Start;
+  StatsMap Commands;
+  StatsMap Functions;
+  StatsMap Files;
+  StatsMap Includes;
+  StatsMap Steps;
+  std::vector<Frame> Frames;
+  std::vector<std::string> IncludeChain;
+  std::thread::id MainThread;
+  std::atomic<std::uint64_t> VariableExpansions;
+  std::atomic<std::uint64_t> GeneratorExpressionEvaluations;
+};
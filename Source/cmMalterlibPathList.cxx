@@ -0,0 +1,186 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmMalterlibPathList.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "cmCryptoHash.h"
+#include "cmGeneratedFileStream.h"
+#include "cmSystemTools.h"
+
+namespace
+{
+  constexpr char CompactMagic[] = "MTLPATHS";
+  constexpr std::size_t CompactHashSize = 32;
+
+  void appendUInt32(std::string &out, std::uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+      out += static_cast<char>((value >> (i * 8)) & 0xFF);
+  }
+
+  struct CompactRecord
+  {
+    std::uint32_t Parent;
+    std::uint32_t NameOffset;
+    std::uint32_t NameLength;
+  };
+
+  class CompactEncoder
+  {
+  public:
+    explicit CompactEncoder(cm::string_view root)
+    {
+      this->Directories.push_back({ cmMalterlibPathList::NoParent, this->AddString(root), static_cast<std::uint32_t>(root.size()) });
+      this->DirectoryIndices.emplace(root, 0);
+    }
+
+    std::uint32_t AddString(cm::string_view value)
+    {
+      auto inserted = this->StringOffsets.emplace(value, static_cast<std::uint32_t>(this->Strings.size()));
+      if (inserted.second)
+        this->Strings.append(value.data(), value.size());
+      return inserted.first->second;
+    }
+
+    std::uint32_t AddDirectory(cm::string_view directory)
+    {
+      auto found = this->DirectoryIndices.find(directory);
+      if (found != this->DirectoryIndices.end())
+        return found->second;
+
+      CompactRecord record;
+      auto slash = directory.rfind('/');
+      if (slash == cm::string_view::npos) {
+        record.Parent = cmMalterlibPathList::NoParent;
+        record.NameOffset = this->AddString(directory);
+        record.NameLength = static_cast<std::uint32_t>(directory.size());
+      } else {
+        cm::string_view name = directory.substr(slash + 1);
+        record.Parent = this->AddDirectory(directory.substr(0, slash));
+        record.NameOffset = this->AddString(name);
+        record.NameLength = static_cast<std::uint32_t>(name.size());
+      }
+
+      auto index = static_cast<std::uint32_t>(this->Directories.size());
+      this->Directories.push_back(record);
+      this->DirectoryIndices.emplace(directory, index);
+      return index;
+    }
+
+    void AddPath(cm::string_view path)
+    {
+      CompactRecord record;
+      auto slash = path.rfind('/');
+      cm::string_view name = path;
+      if (slash == cm::string_view::npos) {
+        record.Parent = cmMalterlibPathList::NoParent;
+      } else {
+        name = path.substr(slash + 1);
+        record.Parent = this->AddDirectory(path.substr(0, slash));
+      }
+      record.NameOffset = this->AddString(name);
+      record.NameLength = static_cast<std::uint32_t>(name.size());
+      this->Paths.push_back(record);
+    }
+
+    std::string Encode() const
+    {
+      std::string payload;
+      for (auto const *records : { &this->Directories, &this->Paths }) {
+        for (auto const &record : *records) {
+          appendUInt32(payload, record.Parent);
+          appendUInt32(payload, record.NameOffset);
+          appendUInt32(payload, record.NameLength);
+        }
+      }
+      payload += this->Strings;
+
+      std::string out(CompactMagic, sizeof(CompactMagic) - 1);
+      appendUInt32(out, cmMalterlibPathList::Version);
+      appendUInt32(out, static_cast<std::uint32_t>(this->Directories.size()));
+      appendUInt32(out, static_cast<std::uint32_t>(this->Paths.size()));
+      appendUInt32(out, static_cast<std::uint32_t>(this->Strings.size()));
+      cmCryptoHash hash(cmCryptoHash::AlgoSHA256);
+      std::vector<unsigned char> digest = hash.ByteHashString(payload);
+      out.append(reinterpret_cast<char const*>(digest.data()), CompactHashSize);
+      out += payload;
+      return out;
+    }
+
+  private:
+    std::vector<CompactRecord> Directories;
+    std::vector<CompactRecord> Paths;
+    std::string Strings;
+    std::unordered_map<cm::string_view, std::uint32_t> DirectoryIndices;
+    std::unordered_map<cm::string_view, std::uint32_t> StringOffsets;
+  };
+
+  // Longest directory that contains every path, ending at a path component
+  // boundary.
+  cm::string_view commonRoot(std::vector<cm::string_view> const &paths)
+  {
+    std::vector<cm::string_view> directories;
+    for (auto const &path : paths) {
+      auto slash = path.rfind('/');
+      if (slash != cm::string_view::npos)
+        directories.push_back(path.substr(0, slash));
+    }
+    if (directories.empty())
+      return cm::string_view();
+
+    cm::string_view first = directories.front();
+    std::size_t length = first.size();
+    for (auto const &directory : directories) {
+      auto mismatch = std::mismatch(first.begin(), first.begin() + std::min(length, directory.size()), directory.begin());
+      length = static_cast<std::size_t>(mismatch.first - first.begin());
+    }
+
+    auto isBoundary = [&](std::size_t candidate) {
+      return std::all_of(directories.begin(), directories.end(),
+        [candidate](cm::string_view directory) {
+          return directory.size() == candidate || directory[candidate] == '/';
+        });
+    };
+    while (length > 0 && !isBoundary(length)) {
+      auto slash = first.rfind('/', length - 1);
+      length = slash == cm::string_view::npos ? 0 : slash;
+    }
+    return first.substr(0, length);
+  }
+}
+
+void cmMalterlibPathList::Write(std::string const& filename, bool compact) const
+{
+  {
+    cmGeneratedFileStream fout(filename);
+    fout.SetCopyIfDifferent(true);
+    for (auto const &path : this->Paths) {
+      fout << path;
+      fout << "\n";
+    }
+  }
+
+  // A sidecar left by an earlier run with compact output would no longer
+  // match the list.
+  if (!compact) {
+    cmSystemTools::RemoveFile(filename + ".compact");
+    return;
+  }
+
+  std::string encoded = this->EncodeCompact();
+  cmGeneratedFileStream fout;
+  fout.Open(filename + ".compact", false, true);
+  fout.SetCopyIfDifferent(true);
+  fout.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+}
+
+std::string cmMalterlibPathList::EncodeCompact() const
+{
+  CompactEncoder encoder(commonRoot(this->Paths));
+  for (auto const &path : this->Paths)
+    encoder.AddPath(path);
+  return encoder.Encode();
+}
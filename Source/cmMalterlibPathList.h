@@ -0,0 +1,55 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cm/string_view>
+
+/** \class cmMalterlibPathList
+ * \brief Path list read back by the Malterlib build system
+ *
+ * The list is written as newline separated paths. With compact output
+ * enabled a binary sidecar is written next to it as <file>.compact, which
+ * can be mapped into memory instead of being parsed. Files are only
+ * replaced when their content changes.
+ *
+ * Compact layout, all integers are little endian uint32:
+ *   Header       Magic "MTLPATHS", Version, DirectoryCount, PathCount,
+ *                StringsSize and the 32 byte SHA-256 of everything after
+ *                the header
+ *   Directories  DirectoryCount x { Parent, NameOffset, NameLength }
+ *   Paths        PathCount x { Directory, NameOffset, NameLength }
+ *   Strings      StringsSize bytes of unique, unterminated names
+ *
+ * Directory 0 is the root shared by all paths. A directory or path is its
+ * parent directory, a slash and its name. Entries without a parent
+ * (NoParent) consist of just their name.
+ */
+class cmMalterlibPathList
+{
+public:
+  static constexpr std::uint32_t Version = 1;
+  static constexpr std::uint32_t NoParent = UINT32_MAX;
+
+  void Add(cm::string_view path) { this->Paths.push_back(path); }
+
+  template <typename Range>
+  void AddAll(Range const& paths)
+  {
+    for (auto const& path : paths)
+      this->Add(path);
+  }
+
+  /** Writes the list to filename and, if compact is set, the sidecar to
+   *  filename + ".compact". */
+  void Write(std::string const& filename, bool compact) const;
+
+  std::string EncodeCompact() const;
+
+private:
+  std::vector<cm::string_view> Paths;
+};
@@ -0,0 +1,81 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include "cmMalterlibPathTrie.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+  bool childLess(std::pair<char, std::uint32_t> const &child, char c)
+  {
+    return child.first < c;
+  }
+}
+
+cmMalterlibPathTrie::cmMalterlibPathTrie(bool caseInsensitive)
+  : Nodes(1)
+  , CaseInsensitive(caseInsensitive)
+{
+}
+
+char cmMalterlibPathTrie::Fold(char c) const
+{
+  if (!this->CaseInsensitive)
+    return c;
+  return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+std::uint32_t cmMalterlibPathTrie::FindChild(std::uint32_t node, char c) const
+{
+  c = this->Fold(c);
+  auto const &children = this->Nodes[node].Children;
+  auto found = std::lower_bound(children.begin(), children.end(), c, childLess);
+  if (found == children.end() || found->first != c)
+    return NoMatch;
+  return found->second;
+}
+
+void cmMalterlibPathTrie::insert(cm::string_view key, std::uint32_t value)
+{
+  std::uint32_t node = 0;
+  for (char c : key) {
+    c = this->Fold(c);
+    auto &children = this->Nodes[node].Children;
+    auto found = std::lower_bound(children.begin(), children.end(), c, childLess);
+    if (found != children.end() && found->first == c) {
+      node = found->second;
+      continue;
+    }
+    auto child = static_cast<std::uint32_t>(this->Nodes.size());
+    children.emplace(found, c, child);
+    this->Nodes.emplace_back();
+    node = child;
+  }
+  if (this->Nodes[node].Value == NoMatch)
+    this->Nodes[node].Value = value;
+}
+
+std::uint32_t cmMalterlibPathTrie::findLongestPrefix(cm::string_view text,
+                                                     std::size_t &length) const
+{
+  std::uint32_t longest = NoMatch;
+  this->visitPrefixes(text, [&](std::uint32_t value, std::size_t prefixLength) {
+    longest = value;
+    length = prefixLength;
+    return true;
+  });
+  return longest;
+}
+
+bool cmMalterlibPathTrie::hasLongerKeys(cm::string_view text) const
+{
+  std::uint32_t node = 0;
+  for (char c : text) {
+    node = this->FindChild(node, c);
+    if (node == NoMatch)
+      return false;
+  }
+  return !this->Nodes[node].Children.empty();
+}
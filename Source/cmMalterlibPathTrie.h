@@ -0,0 +1,75 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <cm/string_view>
+
+/** \class cmMalterlibPathTrie
+ * \brief Character trie mapping path prefixes to values
+ *
+ * Finds every stored key that is a prefix of a string in a single walk
+ * over the string, independent of how many keys are stored.
+ */
+class cmMalterlibPathTrie
+{
+public:
+  static constexpr std::uint32_t NoMatch = UINT32_MAX;
+
+  explicit cmMalterlibPathTrie(bool caseInsensitive = false);
+
+  /** Associates value with key. The first value inserted for a key is
+   *  kept. */
+  void insert(cm::string_view key, std::uint32_t value);
+
+  bool empty() const { return this->Nodes.size() == 1; }
+
+  /** Calls visitor(value, length) for each key that is a prefix of text,
+   *  shortest key first. Stops when the visitor returns false. */
+  template <typename F>
+  void visitPrefixes(cm::string_view text, F&& visitor) const
+  {
+    std::uint32_t node = 0;
+    for (std::size_t i = 0;; ++i) {
+      std::uint32_t value = this->Nodes[node].Value;
+      if (value != NoMatch && !visitor(value, i)) {
+        return;
+      }
+      if (i == text.size()) {
+        return;
+      }
+      node = this->FindChild(node, text[i]);
+      if (node == NoMatch) {
+        return;
+      }
+    }
+  }
+
+  /** Returns the value of the longest key that is a prefix of text and
+   *  sets length to the length of that key, or returns NoMatch. */
+  std::uint32_t findLongestPrefix(cm::string_view text,
+                                  std::size_t& length) const;
+
+  /** Returns whether a key exists that starts with text and is longer
+   *  than it. */
+  bool hasLongerKeys(cm::string_view text) const;
+
+private:
+  struct Node
+  {
+    // Sorted by character
+    std::vector<std::pair<char, std::uint32_t>> Children;
+    std::uint32_t Value = NoMatch;
+  };
+
+  char Fold(char c) const;
+  std::uint32_t FindChild(std::uint32_t node, char c) const;
+
+  std::vector<Node> Nodes;
+  bool CaseInsensitive;
+};
@@ -3,260 +3,400 @@
 
 #include "cmMalterlibRegistry.h"
 
-#include <assert.h>
+#include <cassert>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class cmMalterlibRegistryArena
+{
+public:
+  struct ChildKey
+  {
+    cmMalterlibRegistry const *Parent;
+    char const *Key;
+    char const *Value;
+
+    bool operator==(ChildKey const &other) const
+    {
+      return Parent == other.Parent && Key == other.Key && Value == other.Value;
+    }
+  };
+
+  struct ChildKeyHash
+  {
+    std::size_t operator()(ChildKey const &key) const
+    {
+      std::hash<void const *> hasher;
+      std::size_t hash = hasher(key.Parent);
+      hash ^= hasher(key.Key) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash ^= hasher(key.Value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  // Interned strings are compared by address, so equal strings must always
+  // map to the same storage, including the empty string.
+  cm::string_view intern(cm::string_view str)
+  {
+    if (str.empty())
+      return cm::string_view("", 0);
+
+    auto found = Strings.find(str);
+    if (found != Strings.end())
+      return *found;
+
+    char *storage = allocateString(str.size());
+    memcpy(storage, str.data(), str.size());
+    cm::string_view interned(storage, str.size());
+    Strings.insert(interned);
+    return interned;
+  }
+
+  std::uint32_t allocateNode(cm::string_view key, cm::string_view value)
+  {
+    auto index = static_cast<std::uint32_t>(Nodes.size());
+    Nodes.emplace_back(this);
+    auto &node = Nodes.back();
+    node.Key = intern(key);
+    node.Value = intern(value);
+    return index;
+  }
+
+  cmMalterlibRegistry &node(std::uint32_t index) { return Nodes[index]; }
+
+  std::unordered_map<ChildKey, std::uint32_t, ChildKeyHash> ChildIndex;
+
+private:
+  static constexpr std::size_t BlockSize = 64 * 1024;
+
+  char *allocateString(std::size_t size)
+  {
+    if (size > BlockSize / 4) {
+      Blocks.emplace_back(new char[size]);
+      return Blocks.back().get();
+    }
+    if (size > BlockRemaining) {
+      Blocks.emplace_back(new char[BlockSize]);
+      BlockPosition = Blocks.back().get();
+      BlockRemaining = BlockSize;
+    }
+    char *storage = BlockPosition;
+    BlockPosition += size;
+    BlockRemaining -= size;
+    return storage;
+  }
+
+  std::deque<cmMalterlibRegistry> Nodes;
+  std::unordered_set<cm::string_view> Strings;
+  std::vector<std::unique_ptr<char[]>> Blocks;
+  char *BlockPosition = nullptr;
+  std::size_t BlockRemaining = 0;
+};
 
 namespace
 {
-  char *strEscapeStr(char *_pStrDest, const char *_pStrSource, 
-                     const char *_pEscapeChars, const char *_pReplaceChars, bool _bAddQuotes) {
+  // Appends _Source to _Dest, replacing each character found in
+  // _pEscapeChars with a backslash followed by the character at the same
+  // position in _pReplaceChars. Like the C string based implementation this
+  // replaced, the source ends at the first null character.
+  void appendEscaped(std::string &_Dest, cm::string_view _Source,
+                     const char *_pEscapeChars, const char *_pReplaceChars,
+                     bool _bAddQuotes) {
     assert(strlen(_pEscapeChars) == strlen(_pReplaceChars));
 
-    char *pDest = _pStrDest;
-
-		if (_bAddQuotes)
-			*(pDest++) = _pReplaceChars[0];
-    const char *pParse = _pStrSource;
+    if (_bAddQuotes)
+      _Dest += _pReplaceChars[0];
 
-    while (*pParse) {
-      size_t iEscape = 0;
-      while (_pEscapeChars[iEscape]) {
-        if (*pParse == _pEscapeChars[iEscape])
-          break;
-        ++iEscape;
-      }
-      if (_pEscapeChars[iEscape]) {
-        *(pDest++) = '\\';
-        *(pDest++) = _pReplaceChars[iEscape];
-        ++pParse;
+    const char *pParse = _Source.data();
+    const char *pEnd = pParse + _Source.size();
+    const char *pRunStart = pParse;
+    for (; pParse != pEnd && *pParse; ++pParse) {
+      const char *pEscape = strchr(_pEscapeChars, *pParse);
+      if (!pEscape)
         continue;
-      }
-      *(pDest++) = *(pParse++);
+      _Dest.append(pRunStart, pParse - pRunStart);
+      _Dest += '\\';
+      _Dest += _pReplaceChars[pEscape - _pEscapeChars];
+      pRunStart = pParse + 1;
     }
-		if (_bAddQuotes)
-			*(pDest++) = _pReplaceChars[0];
-    *(pDest++) = 0;
-    return _pStrDest;
+    _Dest.append(pRunStart, pParse - pRunStart);
+
+    if (_bAddQuotes)
+      _Dest += _pReplaceChars[0];
   }
-  
-  template <bool t_bEscapeNewLines>
-  static std::string getEscapedStr(const std::string &_Str, bool _bForceEscape, 
-                                   const std::string &_PreData) {
-    std::string toReturn;
-    bool bNeedEscape = _bForceEscape;
 
+  template <bool t_bEscapeNewLines>
+  bool needsEscape(cm::string_view _Str) {
     if (_Str.empty())
-      bNeedEscape = true;
-
-    if (!bNeedEscape) {
-      size_t Len = _Str.length();
-
-      char Current;
-      char Prev = 0;
-      for (size_t i = 0; i < Len; ++i, (Prev = Current)) {
-        Current = _Str[i];
-        if (Current == '\"' || Current == '{' || Current == '#' 
-            || Current == '\\') {
-          bNeedEscape = true;
-          break;
-        }
-        else if (Prev == '/' && (Current == '*' || Current == '/')) {
-          // Strings containing comments.
-          bNeedEscape = true;
-          break;
-        }
-        else if (Current == '.' || Current == '%' || Current == '&' || Current == '|' || Current == '!' || Current == '_' || Current == '+' || Current == '-') {
-        }
-        else if (Current < '0') {
-          bNeedEscape = true;
-          break;
-        }
-        else if (Current > '9' && Current < 'A') {
-          bNeedEscape = true;
-          break;
-        }
-        else if (Current > 'Z' && Current < 'a') {
-          bNeedEscape = true;
-          break;
-        }
-        else if (Current > 'z') {
-          bNeedEscape = true;
-          break;
-        }
-        else if (t_bEscapeNewLines) {
-          if (Current == '\n') {
-            bNeedEscape = true;
-            break;
-          }
-        }
+      return true;
+
+    char Current;
+    char Prev = 0;
+    for (size_t i = 0; i < _Str.size(); ++i, (Prev = Current)) {
+      Current = _Str[i];
+      if (Current == '\"' || Current == '{' || Current == '#'
+          || Current == '\\') {
+        return true;
+      }
+      else if (Prev == '/' && (Current == '*' || Current == '/')) {
+        // Strings containing comments.
+        return true;
+      }
+      else if (Current == '.' || Current == '%' || Current == '&' || Current == '|' || Current == '!' || Current == '_' || Current == '+' || Current == '-') {
+      }
+      else if (Current < '0') {
+        return true;
+      }
+      else if (Current > '9' && Current < 'A') {
+        return true;
+      }
+      else if (Current > 'Z' && Current < 'a') {
+        return true;
+      }
+      else if (Current > 'z') {
+        return true;
+      }
+      else if (t_bEscapeNewLines) {
+        if (Current == '\n')
+          return true;
       }
     }
+    return false;
+  }
+
+  void appendIndent(std::string &_Dest, size_t _Columns) {
+    size_t numTabs = _Columns / 4;
+    _Dest.append(numTabs, '\t');
+    _Dest.append(_Columns - numTabs * 4, ' ');
+  }
 
-    if (bNeedEscape) {
-      if (t_bEscapeNewLines) {
-        size_t Len = _Str.length();
-        size_t iStart = 0;
-        for (size_t i = 0; i < Len; ++i) {
-          char Current = _Str[i];
-          if (Current == '\n') {
-            cmMalterlibRegistry::addEscapeStr(toReturn, _Str.substr(iStart, (i+1)-iStart),
-                         "\"\\\r\n\t", "\"\\rnt", true);
-            toReturn += "\\\n";
-            toReturn += _PreData;
-            iStart = i+1;
-          }
+  // Escapes _Str if needed. Escaped multi-line values are split into one
+  // quoted string per line, continued on the next line indented to
+  // _ContinuationColumns.
+  template <bool t_bEscapeNewLines>
+  void appendEscapedStr(std::string &_Dest, cm::string_view _Str,
+                        bool _bForceEscape, size_t _ContinuationColumns) {
+    if (!_bForceEscape && !needsEscape<t_bEscapeNewLines>(_Str)) {
+      _Dest.append(_Str.data(), _Str.size());
+      return;
+    }
+
+    if (t_bEscapeNewLines) {
+      size_t iStart = 0;
+      for (size_t i = 0; i < _Str.size(); ++i) {
+        if (_Str[i] == '\n') {
+          appendEscaped(_Dest, _Str.substr(iStart, (i + 1) - iStart),
+                        "\"\\\r\n\t", "\"\\rnt", true);
+          _Dest += "\\\n";
+          appendIndent(_Dest, _ContinuationColumns);
+          iStart = i + 1;
         }
-        cmMalterlibRegistry::addEscapeStr(toReturn, _Str.substr(iStart, Len - iStart),
-                     "\"\\\r\n\t", "\"\\rnt", true);
       }
-      else
-        cmMalterlibRegistry::addEscapeStr(toReturn, _Str, "\"\\\r\n\t", "\"\\rnt", true);
+      appendEscaped(_Dest, _Str.substr(iStart), "\"\\\r\n\t", "\"\\rnt", true);
     }
     else
-      toReturn = _Str;
-    return toReturn;
+      appendEscaped(_Dest, _Str, "\"\\\r\n\t", "\"\\rnt", true);
   }
 
-  std::string makeTabs(std::string const &str) {
+  // Number of columns a line occupies with tabs counted as four columns.
+  size_t getColumns(const char *_pStart, const char *_pEnd) {
     size_t numChars = 0;
-    for (auto const &character : str) {
-      if (character == '\t')
+    for (; _pStart != _pEnd; ++_pStart) {
+      if (*_pStart == '\t')
         numChars += 4;
       else
         ++numChars;
     }
-    size_t numTabs = numChars / 4;
-    std::string returnString = std::string(numTabs, '\t');
-    returnString.insert(returnString.length(), numChars - numTabs * 4, ' ');
-    return returnString;
-  }  
+    return numChars;
+  }
 }
 
+/** \class cmMalterlibRegistryWriter
+ * \brief Serializes a registry tree through a reusable output buffer
+ *
+ * Keys and values are escaped directly into the buffer, which is handed to
+ * the stream in large blocks.
+ */
+class cmMalterlibRegistryWriter
+{
+public:
+  explicit cmMalterlibRegistryWriter(cmGeneratedFileStream &stream)
+    : Stream(stream)
+  {
+    Buffer.reserve(FlushSize + 4096);
+  }
+
+  ~cmMalterlibRegistryWriter() { flush(); }
+
+  void writeNode(cmMalterlibRegistry const &node, size_t depth)
+  {
+    cm::string_view key = node.getKey();
+    cm::string_view value = node.getValue();
+    size_t lineStart = Buffer.size();
+
+    Buffer.append(depth, '\t');
+    if (!value.empty() || node.childCount() == 0) {
+      if (node.RawKey)
+        Buffer.append(key.data(), key.size());
+      else
+        appendEscapedStr<false>(Buffer, key, false, 0);
+      Buffer += ' ';
+      if (node.RawValue)
+        Buffer.append(value.data(), value.size());
+      else {
+        size_t columns =
+          getColumns(Buffer.data() + lineStart, Buffer.data() + Buffer.size());
+        appendEscapedStr<true>(Buffer, value,
+                               value != "true" && value != "false", columns);
+      }
+    } else {
+      appendEscapedStr<false>(Buffer, key, false, 0);
+    }
+    Buffer += '\n';
+
+    if (node.childCount() == 0)
+      return;
+
+    Buffer.append(depth, '\t');
+    Buffer += "{\n";
+    for (auto &child : node.children())
+      writeNode(child, depth + 1);
+    Buffer.append(depth, '\t');
+    Buffer += "}\n";
+
+    if (Buffer.size() >= FlushSize)
+      flush();
+  }
+
+  void flush()
+  {
+    if (Buffer.empty())
+      return;
+    Stream.write(Buffer.data(), static_cast<std::streamsize>(Buffer.size()));
+    Buffer.clear();
+  }
+
+private:
+  static constexpr size_t FlushSize = 256 * 1024;
+
+  cmGeneratedFileStream &Stream;
+  std::string Buffer;
+};
+
 std::string &cmMalterlibRegistry::addEscapeStr(std::string &_StrDest, const std::string &_StrSource, const char *_pEscapedChars, const char *_pReplaceChars, bool _bAddQuotes)
 {
-	const char *pSource = _StrSource.c_str();
-	const char *pParse = pSource;
-	size_t NeededSize = _bAddQuotes ? 3 : 1;
-	while (*pParse) {
-		const char *pEscape = _pEscapedChars;
-		while (*pEscape) {
-			if (*pParse == *pEscape)
-				break;
-			++pEscape;
-		}
-		if (*pEscape)
-			NeededSize += 2;
-		else
-			++NeededSize;
-
-		++pParse;
-	}
-
-	size_t currentLength = _StrDest.length();
-	_StrDest.resize(currentLength + NeededSize);
-	char *pDest = &_StrDest[currentLength];
-	strEscapeStr(pDest, pSource, _pEscapedChars, _pReplaceChars, _bAddQuotes);
-	_StrDest.resize(strlen(&_StrDest[0]));
-	return _StrDest;
+  appendEscaped(_StrDest, _StrSource, _pEscapedChars, _pReplaceChars, _bAddQuotes);
+  return _StrDest;
 }
 
-
 std::string cmMalterlibRegistry::getEscaped(std::string const &_Str, bool _bForceEscape, bool _bEscapeNewLines) {
+  std::string toReturn;
   if (_bEscapeNewLines)
-    return getEscapedStr<true>(_Str, _bForceEscape, {});
+    appendEscapedStr<true>(toReturn, _Str, _bForceEscape, 0);
   else
-    return getEscapedStr<false>(_Str, _bForceEscape, {});
+    appendEscapedStr<false>(toReturn, _Str, _bForceEscape, 0);
+  return toReturn;
+}
+
+cmMalterlibRegistry::ChildIterator::reference
+cmMalterlibRegistry::ChildIterator::operator*() const
+{
+  return Arena->node(Index);
+}
+
+cmMalterlibRegistry::ChildIterator &
+cmMalterlibRegistry::ChildIterator::operator++()
+{
+  Index = Arena->node(Index).NextSibling;
+  return *this;
+}
+
+cmMalterlibRegistry::cmMalterlibRegistry()
+  : OwnedArena(new cmMalterlibRegistryArena)
+  , Arena(OwnedArena.get())
+{
+}
+
+cmMalterlibRegistry::cmMalterlibRegistry(cmMalterlibRegistryArena *arena)
+  : Arena(arena)
+{
 }
 
-cmMalterlibRegistry &cmMalterlibRegistry::setChild(std::string const &key, 
-                                                   std::string const &value) {
-  auto found = ChildrenMap.find(key);
-  if (found != ChildrenMap.end()) {
-    auto &Child = *found->second;
-    Child.Value = value;
-    return Child; 
+cmMalterlibRegistry::~cmMalterlibRegistry() = default;
+
+cmMalterlibRegistry::ChildRange cmMalterlibRegistry::children() const
+{
+  return { ChildIterator(Arena, FirstChild),
+           ChildIterator(Arena, InvalidIndex) };
+}
+
+cmMalterlibRegistry &cmMalterlibRegistry::setChild(cm::string_view key,
+                                                   cm::string_view value) {
+  cm::string_view internedKey = Arena->intern(key);
+  auto found = Arena->ChildIndex.find({ this, internedKey.data(), nullptr });
+  if (found != Arena->ChildIndex.end()) {
+    auto &Child = Arena->node(found->second);
+    Child.Value = Arena->intern(value);
+    return Child;
   }
   return addChild(key, value);
 }
 
 cmMalterlibRegistry &cmMalterlibRegistry::addUniqueChild(
-  std::string const &key, 
-  std::string const &value) {
-  
-  auto found = ChildrenValueMap.find(
-    std::pair<std::string, std::string>(key, value));
-  if (found != ChildrenValueMap.end())
-    return *found->second; 
+  cm::string_view key,
+  cm::string_view value) {
+
+  auto found = Arena->ChildIndex.find(
+    { this, Arena->intern(key).data(), Arena->intern(value).data() });
+  if (found != Arena->ChildIndex.end())
+    return Arena->node(found->second);
   return addChild(key, value);
 }
 
-cmMalterlibRegistry &cmMalterlibRegistry::addChild(std::string const &key, 
-                                                   std::string const &value,
+cmMalterlibRegistry &cmMalterlibRegistry::addChild(cm::string_view key,
+                                                   cm::string_view value,
                                                    bool pushFront) {
-  cmMalterlibRegistry child;
-  child.Key = key;
-  child.Value = value;
-  cmMalterlibRegistry *added;
-  if (pushFront) {
-    Children.push_front(child);
-    added = &Children.front(); 
+  std::uint32_t index = Arena->allocateNode(key, value);
+  auto &added = Arena->node(index);
+  if (FirstChild == InvalidIndex) {
+    FirstChild = index;
+    LastChild = index;
+  } else if (pushFront) {
+    added.NextSibling = FirstChild;
+    FirstChild = index;
   } else {
-    Children.push_back(child);
-    added = &Children.back(); 
+    Arena->node(LastChild).NextSibling = index;
+    LastChild = index;
   }
-  ChildrenMap[key] = added;
-  ChildrenValueMap[std::pair<std::string, std::string>(key, value)] = added;
-  return *added;
+  ++ChildCount;
+  Arena->ChildIndex[{ this, added.Key.data(), nullptr }] = index;
+  Arena->ChildIndex[{ this, added.Key.data(), added.Value.data() }] = index;
+  return added;
 }
 
 void cmMalterlibRegistry::output(cmGeneratedFileStream &stream) {
-  for (auto &child : Children)
-    child.outputRecursive(stream, std::string{});
+  cmMalterlibRegistryWriter writer(stream);
+  for (auto &child : children())
+    writer.writeNode(child, 0);
 }
 
-void cmMalterlibRegistry::outputRecursive(cmGeneratedFileStream &stream, 
-                                          std::string const &indent) {
-  if (!Value.empty() || Children.empty()) {
-    std::string prefix;
-    prefix = indent;
-    if (RawKey)
-      prefix += Key;
-    else
-      prefix += getEscapedStr<false>(Key, false, std::string());
-    prefix += " ";
-    stream << prefix;
-    prefix = makeTabs(prefix);
-    if (RawValue)
-      stream << Value;
-    else
-      stream << getEscapedStr<true>(Value, Value != "true" && Value != "false", prefix);
-  } else {
-    stream << indent;
-    stream << getEscapedStr<false>(Key, false, std::string());
-  }
-  stream << "\n";
-  
-  if (Children.empty())
-    return;
-  
-  stream << indent;
-  stream << "{\n";
-  std::string newIndent = indent;
-  newIndent += "\t";
-  for (auto &child : Children)
-    child.outputRecursive(stream, newIndent);
-  stream << indent;
-  stream << "}\n";
-}
-
-cmMalterlibRegistry cmMalterlibRegistry::pruneLoneChildrenRecursive()
+std::uint32_t cmMalterlibRegistry::pruneLoneChildrenRecursive(std::uint32_t index)
 {
-  if (Children.size() == 1 && !Protected && Key == "%Group")
-    return Children.front().pruneLoneChildrenRecursive();
-  return *this;
+  auto &node = Arena->node(index);
+  if (node.ChildCount == 1 && !node.Protected && node.Key == "%Group")
+    return pruneLoneChildrenRecursive(node.FirstChild);
+  return index;
 }
 
 void cmMalterlibRegistry::pruneLoneChildren() {
-  if (Children.size() == 1) {
-    Children.front() = Children.front().pruneLoneChildrenRecursive();
+  if (ChildCount == 1) {
+    // The lone child is replaced by the first descendant that is not an
+    // unprotected group with a single child.
+    FirstChild = pruneLoneChildrenRecursive(FirstChild);
+    LastChild = FirstChild;
   }
 }
@@ -3,41 +3,110 @@
 
 #pragma once
 
-#include <list>
-#include <map>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <string>
+
+#include <cm/string_view>
+
 #include "cmGeneratedFileStream.h"
 
+class cmMalterlibRegistryArena;
+
+/** \class cmMalterlibRegistry
+ * \brief Node in a Malterlib registry tree
+ *
+ * A default constructed registry is the root of a tree and owns the arena
+ * that stores all nodes below it. Nodes are stored contiguously in the
+ * arena and are linked by index, keys and values are interned in the arena
+ * and children are looked up through a hashed index. References to nodes
+ * stay valid for the lifetime of the root.
+ */
 class cmMalterlibRegistry
 {
 public:
-  cmMalterlibRegistry &addChild(std::string const &key, 
-                                std::string const &value = std::string{},
+  class ChildIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = cmMalterlibRegistry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = cmMalterlibRegistry*;
+    using reference = cmMalterlibRegistry&;
+
+    ChildIterator(cmMalterlibRegistryArena* arena, std::uint32_t index)
+      : Arena(arena)
+      , Index(index)
+    {
+    }
+
+    reference operator*() const;
+    pointer operator->() const { return &**this; }
+    ChildIterator& operator++();
+    bool operator==(ChildIterator const& other) const
+    {
+      return this->Index == other.Index;
+    }
+    bool operator!=(ChildIterator const& other) const
+    {
+      return this->Index != other.Index;
+    }
+
+  private:
+    cmMalterlibRegistryArena* Arena;
+    std::uint32_t Index;
+  };
+
+  struct ChildRange
+  {
+    ChildIterator Begin;
+    ChildIterator End;
+    ChildIterator begin() const { return this->Begin; }
+    ChildIterator end() const { return this->End; }
+  };
+
+  cmMalterlibRegistry();
+  explicit cmMalterlibRegistry(cmMalterlibRegistryArena *arena);
+  ~cmMalterlibRegistry();
+  cmMalterlibRegistry(cmMalterlibRegistry const&) = delete;
+  cmMalterlibRegistry& operator=(cmMalterlibRegistry const&) = delete;
+
+  cmMalterlibRegistry &addChild(cm::string_view key,
+                                cm::string_view value = cm::string_view{},
                                 bool pushFront = false);
-  cmMalterlibRegistry &setChild(std::string const &key, 
-                                std::string const &value);
-  cmMalterlibRegistry &addUniqueChild(std::string const &key, 
-                                      std::string const &value);
+  cmMalterlibRegistry &setChild(cm::string_view key,
+                                cm::string_view value);
+  cmMalterlibRegistry &addUniqueChild(cm::string_view key,
+                                      cm::string_view value);
   void output(cmGeneratedFileStream &stream);
   void pruneLoneChildren();
-  std::vector<cmMalterlibRegistry>::iterator getChildIterator();
+
+  cm::string_view getKey() const { return Key; }
+  cm::string_view getValue() const { return Value; }
+  ChildRange children() const;
+  std::size_t childCount() const { return ChildCount; }
 
   static std::string getEscaped(const std::string &_Str, bool _bForceEscape, bool _bEscapeNewLines);
   static std::string &addEscapeStr(std::string &_StrDest, const std::string &_StrSource, const char *_pEscapedChars, const char *_pReplaceChars, bool _bAddQuotes);
 
-  std::string Key;
-  std::string Value;
-  std::list<cmMalterlibRegistry> Children;
-  std::map<std::string, cmMalterlibRegistry *> ChildrenMap;
-  std::map<std::pair<std::string, std::string>, cmMalterlibRegistry *> 
-    ChildrenValueMap;
   bool Protected = false;
   bool RawKey = false;
   bool RawValue = false;
 
 private:
-  void outputRecursive(cmGeneratedFileStream &stream, 
-                       std::string const &indent);
-  cmMalterlibRegistry pruneLoneChildrenRecursive();
-  
+  friend class cmMalterlibRegistryArena;
+
+  static constexpr std::uint32_t InvalidIndex = UINT32_MAX;
+
+  std::uint32_t pruneLoneChildrenRecursive(std::uint32_t index);
+
+  std::unique_ptr<cmMalterlibRegistryArena> OwnedArena;
+  cmMalterlibRegistryArena *Arena;
+  cm::string_view Key;
+  cm::string_view Value;
+  std::uint32_t FirstChild = InvalidIndex;
+  std::uint32_t LastChild = InvalidIndex;
+  std::uint32_t NextSibling = InvalidIndex;
+  std::uint32_t ChildCount = 0;
 };
@@ -3,21 +3,145 @@
 #include "cmPropertyMap.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
 #include <utility>
 
+#include <cm/memory>
+
+namespace {
+/** Property names shared by all maps.  Properties are only set and read on
+ *  the main thread, so the names are kept in a plain open addressing table
+ *  that is cheaper to probe than an unordered_map.  Names are never freed,
+ *  so maps can hold on to the interned pointers.  */
+class PropertyNames
+{
+public:
+  static PropertyNames& Instance()
+  {
+    static PropertyNames names;
+    return names;
+  }
+
+  std::string const* Find(std::string const& name) const
+  {
+    Node const* const* slot =
+      this->Probe(name, std::hash<std::string>()(name));
+    return *slot ? &(*slot)->Name : nullptr;
+  }
+
+  std::string const* Intern(std::string const& name)
+  {
+    std::size_t const hash = std::hash<std::string>()(name);
+    Node const** slot = this->Probe(name, hash);
+    if (*slot) {
+      return &(*slot)->Name;
+    }
+    this->Names.push_back({ name, hash });
+    // Keep the table at most half full so that every probe ends.
+    if (2 * this->Names.size() > this->Slots.size()) {
+      this->Rehash(2 * this->Slots.size());
+    } else {
+      *slot = &this->Names.back();
+    }
+    return &this->Names.back().Name;
+  }
+
+private:
+  struct Node
+  {
+    std::string Name;
+    std::size_t Hash;
+  };
+
+  PropertyNames() { this->Rehash(1024); }
+
+  Node const** Probe(std::string const& name, std::size_t hash)
+  {
+    std::size_t const mask = this->Slots.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+      Node const*& node = this->Slots[i];
+      if (!node || (node->Hash == hash && node->Name == name)) {
+        return &node;
+      }
+    }
+  }
+
+  Node const* const* Probe(std::string const& name, std::size_t hash) const
+  {
+    return const_cast<PropertyNames*>(this)->Probe(name, hash);
+  }
+
+  void Rehash(std::size_t size)
+  {
+    this->Slots.assign(size, nullptr);
+    std::size_t const mask = size - 1;
+    for (Node const& node : this->Names) {
+      std::size_t i = node.Hash & mask;
+      while (this->Slots[i]) {
+        i = (i + 1) & mask;
+      }
+      this->Slots[i] = &node;
+    }
+  }
+
+  std::vector<Node const*> Slots;
+  std::deque<Node> Names;
+};
+}
+
+std::vector<cmPropertyMap::Entry>::const_iterator cmPropertyMap::Find(
+  std::string const* name) const
+{
+  return std::lower_bound(this->Entries_.begin(), this->Entries_.end(), name,
+                          [](Entry const& entry, std::string const* n) {
+                            return std::less<std::string const*>()(
+                              entry.Name, n);
+                          });
+}
+
+std::string& cmPropertyMap::Emplace(std::string const& name)
+{
+  std::string const* interned = PropertyNames::Instance().Intern(name);
+  auto it = this->Find(interned);
+  if (it == this->Entries_.end() || it->Name != interned) {
+    it =
+      this->Entries_.insert(it, { interned, cm::make_unique<std::string>() });
+  }
+  return *it->Value;
+}
+
+cmPropertyMap::cmPropertyMap(cmPropertyMap const& other)
+{
+  this->Entries_.reserve(other.Entries_.size());
+  for (auto const& entry : other.Entries_) {
+    this->Entries_.push_back(
+      { entry.Name, cm::make_unique<std::string>(*entry.Value) });
+  }
+}
+
+cmPropertyMap& cmPropertyMap::operator=(cmPropertyMap const& other)
+{
+  if (this != &other) {
+    *this = cmPropertyMap(other);
+  }
+  return *this;
+}
+
 void cmPropertyMap::Clear()
 {
-  this->Map_.clear();
+  this->Entries_.clear();
 }
 
 void cmPropertyMap::SetProperty(const std::string& name, const char* value)
 {
   if (!value) {
-    this->Map_.erase(name);
+    this->RemoveProperty(name);
     return;
   }
 
-  this->Map_[name] = value;
+  this->Emplace(name) = value;
 }
 
 void cmPropertyMap::AppendProperty(const std::string& name,
@@ -29,7 +153,7 @@ void cmPropertyMap::AppendProperty(const std::string& name,
   }
 
   {
-    std::string& pVal = this->Map_[name];
+    std::string& pVal = this->Emplace(name);
     if (!pVal.empty() && !asString) {
       pVal += ';';
     }
@@ -39,14 +163,25 @@ void cmPropertyMap::AppendProperty(const std::string& name,
 
 void cmPropertyMap::RemoveProperty(const std::string& name)
 {
-  this->Map_.erase(name);
+  std::string const* interned = PropertyNames::Instance().Find(name);
+  if (!interned) {
+    return;
+  }
+  auto it = this->Find(interned);
+  if (it != this->Entries_.end() && it->Name == interned) {
+    this->Entries_.erase(it);
+  }
 }
 
 cmProp cmPropertyMap::GetPropertyValue(const std::string& name) const
 {
-  auto it = this->Map_.find(name);
-  if (it != this->Map_.end()) {
-    return &it->second;
+  std::string const* interned = PropertyNames::Instance().Find(name);
+  if (!interned) {
+    return nullptr;
+  }
+  auto it = this->Find(interned);
+  if (it != this->Entries_.end() && it->Name == interned) {
+    return it->Value.get();
   }
   return nullptr;
 }
@@ -54,9 +189,9 @@ cmProp cmPropertyMap::GetPropertyValue(const std::string& name) const
 std::vector<std::string> cmPropertyMap::GetKeys() const
 {
   std::vector<std::string> keyList;
-  keyList.reserve(this->Map_.size());
-  for (auto const& item : this->Map_) {
-    keyList.push_back(item.first);
+  keyList.reserve(this->Entries_.size());
+  for (auto const& entry : this->Entries_) {
+    keyList.push_back(*entry.Name);
   }
   std::sort(keyList.begin(), keyList.end());
   return keyList;
@@ -66,9 +201,9 @@ std::vector<std::pair<std::string, std::string>> cmPropertyMap::GetList() const
 {
   using StringPair = std::pair<std::string, std::string>;
   std::vector<StringPair> kvList;
-  kvList.reserve(this->Map_.size());
-  for (auto const& item : this->Map_) {
-    kvList.emplace_back(item.first, item.second);
+  kvList.reserve(this->Entries_.size());
+  for (auto const& entry : this->Entries_) {
+    kvList.emplace_back(*entry.Name, *entry.Value);
   }
   std::sort(kvList.begin(), kvList.end(),
             [](StringPair const& a, StringPair const& b) {
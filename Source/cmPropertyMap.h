@@ -4,8 +4,8 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -13,10 +13,21 @@
 
 /** \class cmPropertyMap
  * \brief String property map.
+ *
+ * Property names are interned in a table shared by all maps, so a map only
+ * stores a pointer to each interned name next to its value, sorted by that
+ * pointer.  Names are added to the table when a property is set.  Looking up
+ * a property never modifies the table.
  */
 class cmPropertyMap
 {
 public:
+  cmPropertyMap() = default;
+  cmPropertyMap(cmPropertyMap const& other);
+  cmPropertyMap(cmPropertyMap&&) noexcept = default;
+  cmPropertyMap& operator=(cmPropertyMap const& other);
+  cmPropertyMap& operator=(cmPropertyMap&&) noexcept = default;
+
   // -- General
 
   //! Clear property list
@@ -46,5 +57,16 @@ public:
   std::vector<std::pair<std::string, std::string>> GetList() const;
 
 private:
-  std::unordered_map<std::string, std::string> Map_;
+  struct Entry
+  {
+    std::string const* Name;
+    // Values are allocated separately so pointers returned by
+    // GetPropertyValue stay valid while other properties are set.
+    std::unique_ptr<std::string> Value;
+  };
+
+  std::vector<Entry>::const_iterator Find(std::string const* name) const;
+  std::string& Emplace(std::string const& name);
+
+  std::vector<Entry> Entries_;
 };
@@ -24,6 +24,15 @@ cmSourceFile::cmSourceFile(cmMakefile* mf, const std::string& name,
   }
 }
 
+cmSourceFile::cmSourceFile(cmSourceFileLocation const& location,
+                           bool generated)
+  : Location(location)
+{
+  if (generated) {
+    this->MarkAsGenerated();
+  }
+}
+
 std::string const& cmSourceFile::GetExtension() const
 {
   return this->Extension;
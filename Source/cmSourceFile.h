@@ -34,6 +34,12 @@ public:
     cmMakefile* mf, const std::string& name, bool generated,
     cmSourceFileLocationKind kind = cmSourceFileLocationKind::Ambiguous);
 
+  /**
+   * Construct from the already computed location of the initial name
+   * referencing it.  A generated source file's location must be known.
+   */
+  cmSourceFile(cmSourceFileLocation const& location, bool generated);
+
   /**
    * Get the custom command for this source file
    */
@@ -3,6 +3,7 @@
 #include "cmSourceFileLocation.h"
 
 #include <cassert>
+#include <utility>
 
 #include <cm/string_view>
 
@@ -27,23 +28,47 @@ cmSourceFileLocation::cmSourceFileLocation(const cmSourceFileLocation& loc)
 cmSourceFileLocation::cmSourceFileLocation(cmMakefile const* mf,
                                            const std::string& name,
                                            cmSourceFileLocationKind kind)
+  : cmSourceFileLocation(
+      mf, name,
+      NormalizeDirectory(mf, cmSystemTools::GetFilenamePath(name), kind),
+      kind)
+{
+}
+
+cmSourceFileLocation::cmSourceFileLocation(cmMakefile const* mf,
+                                           const std::string& name,
+                                           std::string directory,
+                                           cmSourceFileLocationKind kind)
   : Makefile(mf)
+  , Directory(std::move(directory))
 {
   this->AmbiguousDirectory = !cmSystemTools::FileIsFullPath(name);
   this->AmbiguousExtension = true;
-  this->Directory = cmSystemTools::GetFilenamePath(name);
-  if (cmSystemTools::FileIsFullPath(this->Directory)) {
-    this->Directory = cmSystemTools::CollapseFullPath(this->Directory);
-  }
   this->Name = cmSystemTools::GetFilenameName(name);
   if (kind == cmSourceFileLocationKind::Known) {
-    this->DirectoryUseSource();
+    // NormalizeDirectory already placed the directory in the source tree.
+    this->AmbiguousDirectory = false;
     this->AmbiguousExtension = false;
   } else {
     this->UpdateExtension(name);
   }
 }
 
+std::string cmSourceFileLocation::NormalizeDirectory(
+  cmMakefile const* mf, std::string const& directory,
+  cmSourceFileLocationKind kind)
+{
+  if (cmSystemTools::FileIsFullPath(directory)) {
+    return cmSystemTools::CollapseFullPath(directory);
+  }
+  if (kind == cmSourceFileLocationKind::Known) {
+    assert(mf);
+    return cmSystemTools::CollapseFullPath(
+      directory, mf->GetCurrentSourceDirectory());
+  }
+  return directory;
+}
+
 std::string cmSourceFileLocation::GetFullPath() const
 {
   std::string path = this->GetDirectory();
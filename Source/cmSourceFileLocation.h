@@ -30,6 +30,14 @@ public:
   cmSourceFileLocation(
     cmMakefile const* mf, const std::string& name,
     cmSourceFileLocationKind kind = cmSourceFileLocationKind::Ambiguous);
+  /**
+   * Construct for a source file whose directory, as returned by
+   * NormalizeDirectory() for the directory part of the name, is already
+   * known.  Callers creating many locations can then normalize each
+   * directory only once.
+   */
+  cmSourceFileLocation(cmMakefile const* mf, const std::string& name,
+                       std::string directory, cmSourceFileLocationKind kind);
   cmSourceFileLocation();
   cmSourceFileLocation(const cmSourceFileLocation& loc);
 
@@ -88,6 +96,14 @@ public:
    */
   cmMakefile const* GetMakefile() const { return this->Makefile; }
 
+  /**
+   * Normalize the directory part of a source file name the same way the
+   * constructor does for the given kind of location.
+   */
+  static std::string NormalizeDirectory(cmMakefile const* mf,
+                                        std::string const& directory,
+                                        cmSourceFileLocationKind kind);
+
 private:
   cmMakefile const* const Makefile = nullptr;
   bool AmbiguousDirectory = true;
@@ -221,6 +221,11 @@ std::string const& cmState::GetGlobVerifyScript() const
   return this->GlobVerificationManager->GetVerifyScript();
 }
 
+std::string const& cmState::GetGlobVerifyInfo() const
+{
+  return this->GlobVerificationManager->GetVerifyInfo();
+}
+
 std::string const& cmState::GetGlobVerifyStamp() const
 {
   return this->GlobVerificationManager->GetVerifyStamp();
@@ -537,6 +542,11 @@ cmState::Command cmState::GetCommandByExactName(std::string const& name) const
   return nullptr;
 }
 
+bool cmState::IsScriptedCommand(std::string const& name) const
+{
+  return this->ScriptedCommands.find(name) != this->ScriptedCommands.end();
+}
+
 std::vector<std::string> cmState::GetCommandNames() const
 {
   std::vector<std::string> commandNames;
@@ -156,6 +156,8 @@ public:
   Command GetCommand(std::string const& name) const;
   // Returns a command from its name, or nullptr
   Command GetCommandByExactName(std::string const& name) const;
+  // Returns whether a lower case name refers to a function or macro
+  bool IsScriptedCommand(std::string const& name) const;
 
   void AddBuiltinCommand(std::string const& name,
                          std::unique_ptr<cmCommand> command);
@@ -209,6 +211,11 @@ public:
 
   static std::string ModeToString(Mode mode);
 
+  cmListFileParseCache* GetListFileParseCache()
+  {
+    return &this->ListFileParseCache;
+  }
+
 private:
   friend class cmake;
   void AddCacheEntry(const std::string& key, const char* value,
@@ -217,6 +224,7 @@ private:
 
   bool DoWriteGlobVerifyTarget() const;
   std::string const& GetGlobVerifyScript() const;
+  std::string const& GetGlobVerifyInfo() const;
   std::string const& GetGlobVerifyStamp() const;
   bool SaveVerificationScript(const std::string& path);
   void AddGlobCacheEntry(bool recurse, bool listDirectories,
@@ -234,6 +242,7 @@ private:
   cmPropertyMap GlobalProperties;
   std::unique_ptr<cmCacheManager> CacheManager;
   std::unique_ptr<cmGlobVerificationManager> GlobVerificationManager;
+  cmListFileParseCache ListFileParseCache;
 
   cmLinkedTree<cmStateDetail::BuildsystemDirectoryStateType>
     BuildsystemDirectory;
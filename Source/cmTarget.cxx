@@ -730,6 +730,8 @@ void cmTarget::AddSources(std::vector<std::string> const& srcs)
 {
   std::string srcFiles;
   const char* sep = "";
+  std::vector<std::string> files;
+  files.reserve(srcs.size());
   for (auto filename : srcs) {
     if (!cmGeneratorExpression::StartsWithGeneratorExpression(filename)) {
       if (!filename.empty()) {
@@ -738,12 +740,13 @@ void cmTarget::AddSources(std::vector<std::string> const& srcs)
           return;
         }
       }
-      this->impl->Makefile->GetOrCreateSource(filename);
+      files.push_back(filename);
     }
     srcFiles += sep;
     srcFiles += filename;
     sep = ";";
   }
+  this->impl->Makefile->GetOrCreateSources(files);
   if (!srcFiles.empty()) {
     cmListFileBacktrace lfbt = this->impl->Makefile->GetBacktrace();
     this->impl->SourceEntries.push_back(std::move(srcFiles));
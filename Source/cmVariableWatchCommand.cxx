@@ -50,16 +50,16 @@ void cmVariableWatchCommandVariableAccessed(const std::string& variable,
     const auto fakeLineNo =
       std::numeric_limits<decltype(cmListFileArgument::Line)>::max();
 
-    std::vector<cmListFileArgument> newLFFArgs{
-      { variable, cmListFileArgument::Quoted, fakeLineNo },
-      { accessString, cmListFileArgument::Quoted, fakeLineNo },
-      { newValue ? newValue : "", cmListFileArgument::Quoted, fakeLineNo },
-      { *currentListFile, cmListFileArgument::Quoted, fakeLineNo },
-      { stack, cmListFileArgument::Quoted, fakeLineNo }
-    };
+    cmListFileArgumentBuilder newLFFArgs;
+    newLFFArgs.Add(variable, cmListFileArgument::Quoted, fakeLineNo);
+    newLFFArgs.Add(accessString, cmListFileArgument::Quoted, fakeLineNo);
+    newLFFArgs.Add(newValue ? newValue : "", cmListFileArgument::Quoted,
+                   fakeLineNo);
+    newLFFArgs.Add(*currentListFile, cmListFileArgument::Quoted, fakeLineNo);
+    newLFFArgs.Add(stack, cmListFileArgument::Quoted, fakeLineNo);
 
     cmListFileFunction newLFF{ data->Command, fakeLineNo,
-                               std::move(newLFFArgs) };
+                               newLFFArgs.Build() };
     cmExecutionStatus status(*makefile);
     if (!makefile->ExecuteCommand(newLFF, status)) {
       cmSystemTools::Error(
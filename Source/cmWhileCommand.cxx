@@ -79,7 +79,7 @@ bool cmWhileFunctionBlocker::Replay(std::vector<cmListFileFunction> functions,
       std::string err = "had incorrect arguments: ";
       for (cmListFileArgument const& arg : this->Args) {
         err += (arg.Delim ? "\"" : "");
-        err += arg.Value;
+        err += std::string(arg.Value);
         err += (arg.Delim ? "\"" : "");
         err += " ";
       }
@@ -1106,10 +1106,13 @@ bool cmake::SetArgs(const std::vector<std::string>& args)
         "--profiling-format specified but no --profiling-output!");
       return false;
     }
-    if (profilingFormat == "google-trace"_s) {
+    if (profilingFormat == "google-trace"_s || profilingFormat == "summary"_s) {
       try {
-        this->ProfilingOutput =
-          cm::make_unique<cmMakefileProfilingData>(profilingOutput);
+        this->ProfilingOutput = cm::make_unique<cmMakefileProfilingData>(
+          profilingOutput,
+          profilingFormat == "summary"_s
+            ? cmMakefileProfilingData::Format::Summary
+            : cmMakefileProfilingData::Format::GoogleTrace);
       } catch (std::runtime_error& e) {
         cmSystemTools::Error(
           cmStrCat("Could not start profiling: ", e.what()));
@@ -2028,8 +2031,22 @@ int cmake::ActualConfigure()
   this->FileAPI->ReadQueries();
 #endif
 
+  // Reuse the list files parsed by the previous run if asked to.
+  bool const useParseCache = cmIsOn(
+    this->State->GetInitializedCacheValue("CMAKE_LIST_FILE_PARSE_CACHE"));
+  this->UnwatchUnusedCli("CMAKE_LIST_FILE_PARSE_CACHE");
+  std::string const parseCacheFile = cmStrCat(
+    this->GetHomeOutputDirectory(), "/CMakeFiles/ListFileParseCache.bin");
+  if (useParseCache) {
+    this->State->GetListFileParseCache()->Load(parseCacheFile);
+  }
+
   // actually do the configure
   this->GlobalGenerator->Configure();
+
+  if (useParseCache) {
+    this->State->GetListFileParseCache()->Save(parseCacheFile);
+  }
   // Before saving the cache
   // if the project did not define one of the entries below, add them now
   // so users can edit the values in the cache:
@@ -2294,10 +2311,21 @@ int cmake::Generate()
   if (!this->GlobalGenerator) {
     return -1;
   }
-  if (!this->GlobalGenerator->Compute()) {
-    return -1;
+  {
+#if !defined(CMAKE_BOOTSTRAP)
+    cmMakefileProfilingData::RAII profilingEntry(this, "generate", "Compute");
+#endif
+    if (!this->GlobalGenerator->Compute()) {
+      return -1;
+    }
+  }
+  {
+#if !defined(CMAKE_BOOTSTRAP)
+    cmMakefileProfilingData::RAII profilingEntry(this, "generate",
+                                                 "Generate");
+#endif
+    this->GlobalGenerator->Generate();
   }
-  this->GlobalGenerator->Generate();
   if (!this->GraphVizFile.empty()) {
     std::cout << "Generate graphviz: " << this->GraphVizFile << std::endl;
     this->GenerateGraphViz(this->GraphVizFile);
@@ -2348,6 +2376,11 @@ std::string const& cmake::GetGlobVerifyScript() const
   return this->State->GetGlobVerifyScript();
 }
 
+std::string const& cmake::GetGlobVerifyInfo() const
+{
+  return this->State->GetGlobVerifyInfo();
+}
+
 std::string const& cmake::GetGlobVerifyStamp() const
 {
   return this->State->GetGlobVerifyStamp();
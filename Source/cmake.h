@@ -327,6 +327,7 @@ public:
 
   bool DoWriteGlobVerifyTarget() const;
   std::string const& GetGlobVerifyScript() const;
+  std::string const& GetGlobVerifyInfo() const;
   std::string const& GetGlobVerifyStamp() const;
   void AddGlobCacheEntry(bool recurse, bool listDirectories,
                          bool followSymlinks, const std::string& relative,
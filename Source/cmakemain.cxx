@@ -106,7 +106,7 @@ const char* cmDocumentationOptions[][2] = {
 #  if !defined(CMAKE_BOOTSTRAP)
   { "--profiling-format=<fmt>",
     "Output data for profiling CMake scripts. Supported formats: "
-    "google-trace" },
+    "google-trace, summary" },
   { "--profiling-output=<file>",
     "Select an output path for the profiling data enabled through "
     "--profiling-format." },
@@ -14,6 +14,7 @@
 
 #include "cmConsoleBuf.h"
 #include "cmDuration.h"
+#include "cmGlobVerificationManager.h"
 #include "cmGlobalGenerator.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
@@ -1525,6 +1526,16 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
     }
 #endif
 
+#if !defined(CMAKE_BOOTSTRAP)
+    // Internal CONFIGURE_DEPENDS glob verification
+    if (args[1] == "cmake_verify_globs" && args.size() == 3) {
+      return cmGlobVerificationManager::RunVerification(
+               cmSystemTools::CollapseFullPath(args[2]))
+        ? 0
+        : 1;
+    }
+#endif
+
     // Internal depfile transformation
     if (args[1] == "cmake_transform_depfile" && args.size() == 10) {
       auto format = cmDepfileFormat::GccDepfile;
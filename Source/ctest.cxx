@@ -44,6 +44,9 @@ static const char* cmDocumentationOptions[][2] = {
   { "--test-output-size-failed <size>",
     "Limit the output for failed tests "
     "to <size> bytes" },
+  { "--test-output-streaming",
+    "Keep only the head and tail of test output "
+    "in memory" },
   { "-F", "Enable failover." },
   { "-j <jobs>, --parallel <jobs>",
     "Run the tests in parallel using the "
@@ -101,6 +104,12 @@ static const char* cmDocumentationOptions[][2] = {
     "Run a specific number of tests by number." },
   { "-U, --union", "Take the Union of -I and -R" },
   { "--rerun-failed", "Run only the tests that failed previously" },
+  { "--shard <i>/<n>",
+    "Run the i-th of n shards of the tests and save their results" },
+  { "--shard-cost-data <file>",
+    "Balance shards using the cost data in the given file" },
+  { "--merge-shards <file>[;<file>]",
+    "Report the saved results of shards as one test run" },
   { "--repeat until-fail:<n>, --repeat-until-fail <n>",
     "Require each test to run <n> times without failing in order to pass" },
   { "--repeat until-pass:<n>",
@@ -134,12 +143,16 @@ static const char* cmDocumentationOptions[][2] = {
   { "--test-command", "The test to run with the --build-and-test option." },
   { "--test-timeout", "The time limit in seconds, internal use only." },
   { "--test-load", "CPU load threshold for starting new parallel tests." },
+  { "--test-memory-budget <MiB>",
+    "Memory limit for starting new parallel tests." },
   { "--tomorrow-tag", "Nightly or experimental starts with next day tag." },
   { "--overwrite", "Overwrite CTest configuration option." },
   { "--extra-submit <file>[;<file>]", "Submit extra files to the dashboard." },
   { "--force-new-ctest-process",
     "Run child CTest instances as new processes" },
   { "--schedule-random", "Use a random order for scheduling tests" },
+  { "--schedule-critical-path",
+    "Start tests gating the longest dependency chains first" },
   { "--submit-index",
     "Submit individual dashboard tests with specific index" },
   { "--timeout <seconds>", "Set the default test timeout." },
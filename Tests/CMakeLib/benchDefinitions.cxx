@@ -0,0 +1,74 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+// Times variable lookups through deep stacks of function scopes.
+// Usage: benchDefinitions [depth] [lookups]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmDefinitions.h"
+#include "cmLinkedTree.h"
+
+int main(int argc, char* argv[])
+{
+  using Tree = cmLinkedTree<cmDefinitions>;
+
+  int depth = argc > 1 ? std::atoi(argv[1]) : 64;
+  long lookups = argc > 2 ? std::atol(argv[2]) : 1000000;
+  if (depth < 1 || lookups < 1) {
+    std::cerr << "usage: benchDefinitions [depth] [lookups]\n";
+    return 1;
+  }
+
+  Tree tree;
+  Tree::iterator top = tree.Push(tree.Root());
+  std::vector<std::string> keys;
+  for (int i = 0; i < 64; ++i) {
+    keys.push_back("VAR_" + std::to_string(i));
+    top->Set(keys.back(), "value");
+  }
+  Tree::iterator leaf = top;
+  for (int i = 1; i < depth; ++i) {
+    leaf = tree.Push(leaf);
+    leaf->Set("LOCAL_" + std::to_string(i), "local");
+  }
+
+  enum Writes
+  {
+    NoWrites,
+    LocalWrites,
+    ParentWrites
+  };
+
+  auto run = [&](char const* name, Writes writes) {
+    std::size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < lookups; ++i) {
+      std::string const& key = keys[static_cast<std::size_t>(i) % keys.size()];
+      if (i % 16 == 0) {
+        if (writes == LocalWrites) {
+          leaf->Set("LOCAL", key);
+        } else if (writes == ParentWrites) {
+          top->Set(key, "value");
+        }
+      }
+      if (cmDefinitions::Get(key, leaf, tree.Root())) {
+        ++found;
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << elapsed.count() / lookups
+              << " ns/lookup at depth " << depth << " (" << found
+              << " found)\n";
+  };
+
+  run("read only", NoWrites);
+  run("local writes", LocalWrites);
+  run("parent writes", ParentWrites);
+  return 0;
+}
@@ -0,0 +1,123 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+// Measures heap usage and lookup time of source file properties in a
+// synthetic project, compared to a map keyed by property name strings.
+// Usage: benchPropertyMap [sources] [lookups]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cmPropertyMap.h"
+
+namespace {
+std::size_t LiveBytes = 0;
+}
+
+// Prefix each allocation with its size so live heap bytes can be tracked.
+void* operator new(std::size_t size)
+{
+  void* p = std::malloc(size + sizeof(std::max_align_t));
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  *static_cast<std::size_t*>(p) = size;
+  LiveBytes += size;
+  return static_cast<char*>(p) + sizeof(std::max_align_t);
+}
+
+void operator delete(void* p) noexcept
+{
+  if (p) {
+    char* base = static_cast<char*>(p) - sizeof(std::max_align_t);
+    LiveBytes -= *reinterpret_cast<std::size_t*>(base);
+    std::free(base);
+  }
+}
+
+void operator delete(void* p, std::size_t /*unused*/) noexcept
+{
+  operator delete(p);
+}
+
+int main(int argc, char* argv[])
+{
+  long sources = argc > 1 ? std::atol(argv[1]) : 100000;
+  long lookups = argc > 2 ? std::atol(argv[2]) : 10000000;
+  if (sources < 1 || lookups < 1) {
+    std::cerr << "usage: benchPropertyMap [sources] [lookups]\n";
+    return 1;
+  }
+
+  // Properties commonly set on sources by large projects.
+  std::vector<std::string> const names = {
+    "COMPILE_OPTIONS",  "COMPILE_DEFINITIONS",     "INCLUDE_DIRECTORIES",
+    "LANGUAGE",         "LOCATION",                "GENERATED",
+    "HEADER_FILE_ONLY", "SKIP_PRECOMPILE_HEADERS", "SKIP_AUTOGEN",
+    "OBJECT_DEPENDS"
+  };
+  std::vector<std::string> const values = {
+    "-Wall", "FOO=1", "/usr/include", "CXX", "/src/file.cxx",
+    "0",     "OFF",   "OFF",          "ON",  "/src/file.h"
+  };
+
+  auto report = [&](char const* name, std::size_t bytes, double ns,
+                    std::size_t found) {
+    std::cout << name << ": " << bytes / sources << " bytes/source, " << ns
+              << " ns/lookup (" << found << " found)\n";
+  };
+
+  {
+    std::size_t before = LiveBytes;
+    std::vector<std::unordered_map<std::string, std::string>> maps(
+      static_cast<std::size_t>(sources));
+    for (auto& map : maps) {
+      for (std::size_t i = 0; i < names.size(); ++i) {
+        map[names[i]] = values[i];
+      }
+    }
+    std::size_t bytes = LiveBytes - before;
+    std::size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < lookups; ++i) {
+      auto const& map = maps[static_cast<std::size_t>(i % sources)];
+      if (map.find(names[static_cast<std::size_t>(i) % names.size()]) !=
+          map.end()) {
+        ++found;
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    report("string keys", bytes, elapsed.count() / lookups, found);
+  }
+
+  {
+    std::size_t before = LiveBytes;
+    std::vector<cmPropertyMap> maps(static_cast<std::size_t>(sources));
+    for (auto& map : maps) {
+      for (std::size_t i = 0; i < names.size(); ++i) {
+        map.SetProperty(names[i], values[i].c_str());
+      }
+    }
+    std::size_t bytes = LiveBytes - before;
+    std::size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < lookups; ++i) {
+      auto const& map = maps[static_cast<std::size_t>(i % sources)];
+      if (map.GetPropertyValue(
+            names[static_cast<std::size_t>(i) % names.size()])) {
+        ++found;
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+    report("cmPropertyMap", bytes, elapsed.count() / lookups, found);
+  }
+  return 0;
+}
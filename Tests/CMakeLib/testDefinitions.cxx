@@ -0,0 +1,145 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cmDefinitions.h"
+#include "cmLinkedTree.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+using Tree = cmLinkedTree<cmDefinitions>;
+
+static bool isValue(std::string const* value, char const* expected)
+{
+  return value && *value == expected;
+}
+
+static bool testLocalAndParent()
+{
+  std::cout << "testLocalAndParent()\n";
+  Tree tree;
+  Tree::iterator top = tree.Push(tree.Root());
+  top->Set("A", "top");
+  Tree::iterator child = tree.Push(top);
+  child->Set("B", "child");
+
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", child, tree.Root()), "top"));
+  ASSERT_TRUE(isValue(cmDefinitions::Get("B", child, tree.Root()), "child"));
+  ASSERT_TRUE(cmDefinitions::Get("B", top, tree.Root()) == nullptr);
+  ASSERT_TRUE(cmDefinitions::Get("C", child, tree.Root()) == nullptr);
+
+  child->Set("A", "shadowed");
+  ASSERT_TRUE(
+    isValue(cmDefinitions::Get("A", child, tree.Root()), "shadowed"));
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", top, tree.Root()), "top"));
+
+  child->Unset("A");
+  ASSERT_TRUE(cmDefinitions::Get("A", child, tree.Root()) == nullptr);
+  ASSERT_TRUE(cmDefinitions::HasKey("A", child, tree.Root()));
+  return true;
+}
+
+static bool testParentModifiedAfterLookup()
+{
+  std::cout << "testParentModifiedAfterLookup()\n";
+  Tree tree;
+  Tree::iterator top = tree.Push(tree.Root());
+  Tree::iterator middle = tree.Push(top);
+  Tree::iterator child = tree.Push(middle);
+
+  ASSERT_TRUE(cmDefinitions::Get("A", child, tree.Root()) == nullptr);
+  top->Set("A", "1");
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", child, tree.Root()), "1"));
+  top->Set("A", "2");
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", child, tree.Root()), "2"));
+  middle->Set("A", "middle");
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", child, tree.Root()), "middle"));
+  middle->Unset("A");
+  ASSERT_TRUE(cmDefinitions::Get("A", child, tree.Root()) == nullptr);
+  ASSERT_TRUE(cmDefinitions::Get("A", middle, tree.Root()) == nullptr);
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", top, tree.Root()), "2"));
+  return true;
+}
+
+static bool testRaise()
+{
+  std::cout << "testRaise()\n";
+  Tree tree;
+  Tree::iterator top = tree.Push(tree.Root());
+  top->Set("A", "top");
+  Tree::iterator child = tree.Push(top);
+
+  // Mirrors set(PARENT_SCOPE): localize, then modify the parent.
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", child, tree.Root()), "top"));
+  cmDefinitions::Raise("A", child, tree.Root());
+  top->Set("A", "parent");
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", child, tree.Root()), "top"));
+  ASSERT_TRUE(isValue(cmDefinitions::Get("A", top, tree.Root()), "parent"));
+
+  cmDefinitions::Raise("B", child, tree.Root());
+  top->Set("B", "parent");
+  ASSERT_TRUE(cmDefinitions::Get("B", child, tree.Root()) == nullptr);
+  return true;
+}
+
+static bool testDeepStack()
+{
+  std::cout << "testDeepStack()\n";
+  Tree tree;
+  std::vector<Tree::iterator> scopes;
+  scopes.push_back(tree.Push(tree.Root()));
+  scopes.back()->Set("ROOT", "root");
+  for (int i = 1; i < 100; ++i) {
+    scopes.push_back(tree.Push(scopes.back()));
+    scopes.back()->Set("V" + std::to_string(i), std::to_string(i));
+  }
+
+  Tree::iterator leaf = scopes.back();
+  for (int pass = 0; pass < 2; ++pass) {
+    ASSERT_TRUE(
+      isValue(cmDefinitions::Get("ROOT", leaf, tree.Root()), "root"));
+    ASSERT_TRUE(isValue(cmDefinitions::Get("V50", leaf, tree.Root()), "50"));
+    ASSERT_TRUE(cmDefinitions::Get("V50", scopes[49], tree.Root()) == nullptr);
+  }
+
+  scopes[75]->Set("V50", "shadowed");
+  ASSERT_TRUE(
+    isValue(cmDefinitions::Get("V50", leaf, tree.Root()), "shadowed"));
+  ASSERT_TRUE(
+    isValue(cmDefinitions::Get("V50", scopes[60], tree.Root()), "50"));
+  scopes[0]->Unset("ROOT");
+  ASSERT_TRUE(cmDefinitions::Get("ROOT", leaf, tree.Root()) == nullptr);
+
+  tree.Pop(leaf);
+  Tree::iterator replacement = tree.Push(scopes[98]);
+  ASSERT_TRUE(cmDefinitions::Get("V99", replacement, tree.Root()) == nullptr);
+  ASSERT_TRUE(
+    isValue(cmDefinitions::Get("V50", replacement, tree.Root()), "shadowed"));
+  return true;
+}
+
+int testDefinitions(int /*unused*/, char* /*unused*/ [])
+{
+  if (!testLocalAndParent()) {
+    return 1;
+  }
+  if (!testParentModifiedAfterLookup()) {
+    return 1;
+  }
+  if (!testRaise()) {
+    return 1;
+  }
+  if (!testDeepStack()) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "cmGeneratorExpression.h"
+#include "cmListFileCache.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+// The expressions below depend on nothing but the configuration, so they
+// can be evaluated without a local generator.
+static std::string evaluate(std::string const& input,
+                            std::string const& config)
+{
+  return cmGeneratorExpression::Evaluate(input, nullptr, config);
+}
+
+static bool testEvaluateByConfig()
+{
+  std::cout << "testEvaluateByConfig()\n";
+  std::string const input = "a$<$<CONFIG:Debug>:-d>$<COMMA>$<CONFIG>";
+  for (int pass = 0; pass < 2; ++pass) {
+    ASSERT_TRUE(evaluate(input, "Debug") == "a-d,Debug");
+    ASSERT_TRUE(evaluate(input, "Release") == "a,Release");
+    ASSERT_TRUE(evaluate(input, "") == "a,");
+  }
+  ASSERT_TRUE(evaluate("$<LOWER_CASE:$<CONFIG>>", "RelWithDebInfo") ==
+              "relwithdebinfo");
+  ASSERT_TRUE(evaluate("$<LOWER_CASE:$<CONFIG>>", "Debug") == "debug");
+  ASSERT_TRUE(evaluate("no expressions", "Debug") == "no expressions");
+  return true;
+}
+
+static bool testSharedParse()
+{
+  std::cout << "testSharedParse()\n";
+  std::string const input = "$<IF:$<CONFIG:Debug,Release>,yes,no>";
+  cmGeneratorExpression ge;
+  std::unique_ptr<cmCompiledGeneratorExpression> first = ge.Parse(input);
+  std::unique_ptr<cmCompiledGeneratorExpression> second = ge.Parse(input);
+  ASSERT_TRUE(first->GetInput() == input);
+  ASSERT_TRUE(&first->GetInput() == &second->GetInput());
+  ASSERT_TRUE(first->Evaluate(nullptr, "Release") == "yes");
+  ASSERT_TRUE(second->Evaluate(nullptr, "MinSizeRel") == "no");
+  ASSERT_TRUE(first->GetHadContextSensitiveCondition());
+  ASSERT_TRUE(evaluate(input, "Debug") == "yes");
+  return true;
+}
+
+int testGeneratorExpression(int /*unused*/, char* /*unused*/ [])
+{
+  if (!testEvaluateByConfig()) {
+    return 1;
+  }
+  if (!testSharedParse()) {
+    return 1;
+  }
+  return 0;
+}
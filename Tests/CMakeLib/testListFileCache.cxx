@@ -0,0 +1,117 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cm/string_view>
+
+#include "cmListFileCache.h"
+#include "cmMessenger.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+// Whether the arguments view consecutive parts of one buffer.
+static bool shareBuffer(std::vector<cmListFileArgument> const& args)
+{
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    if (args[i].Value.data() !=
+        args[i - 1].Value.data() + args[i - 1].Value.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool inBuffer(cmListFileArgument const& arg,
+                     std::vector<cmListFileArgument> const& args)
+{
+  char const* begin = args.front().Value.data();
+  char const* end = args.back().Value.data() + args.back().Value.size();
+  return arg.Value.data() >= begin && arg.Value.data() < end;
+}
+
+static bool testBuilder()
+{
+  std::cout << "testBuilder()\n";
+  cmListFileArgumentBuilder builder;
+  ASSERT_TRUE(builder.Build().empty());
+
+  std::string const value = "a string that does not fit in place";
+  builder.Add("x", cmListFileArgument::Unquoted, 1);
+  builder.Add(value, cmListFileArgument::Quoted, 2);
+  builder.Add("", cmListFileArgument::Bracket, 3);
+  std::vector<cmListFileArgument> first = builder.Build();
+  ASSERT_TRUE(first.size() == 3);
+  ASSERT_TRUE(first[0].Value == "x");
+  ASSERT_TRUE(first[0].Delim == cmListFileArgument::Unquoted);
+  ASSERT_TRUE(first[0].Line == 1);
+  ASSERT_TRUE(first[1].Value == value);
+  ASSERT_TRUE(first[1].Delim == cmListFileArgument::Quoted);
+  ASSERT_TRUE(first[2].Value.empty());
+  ASSERT_TRUE(first[2].Delim == cmListFileArgument::Bracket);
+  ASSERT_TRUE(shareBuffer(first));
+
+  // The builder starts over and its arguments use a buffer of their own.
+  builder.Add("y", cmListFileArgument::Unquoted, 4);
+  std::vector<cmListFileArgument> second = builder.Build();
+  ASSERT_TRUE(second.size() == 1);
+  ASSERT_TRUE(second[0].Value == "y");
+  ASSERT_TRUE(!inBuffer(second[0], first));
+  ASSERT_TRUE(first[1].Value == value);
+  return true;
+}
+
+static bool testParsedArguments()
+{
+  std::cout << "testParsedArguments()\n";
+  cmMessenger messenger;
+  cmListFileArgument survivor;
+  {
+    cmListFile listFile;
+    ASSERT_TRUE(listFile.ParseString("first(x \"y z\" [[w]])\n"
+                                     "second(v)\n",
+                                     "testParsedArguments", &messenger,
+                                     cmListFileBacktrace()));
+    ASSERT_TRUE(listFile.Functions.size() == 2);
+    std::vector<cmListFileArgument> const& first =
+      listFile.Functions[0].Arguments();
+    std::vector<cmListFileArgument> const& second =
+      listFile.Functions[1].Arguments();
+    ASSERT_TRUE(first.size() == 3);
+    ASSERT_TRUE(first[1].Value == "y z");
+    ASSERT_TRUE(first[1].Delim == cmListFileArgument::Quoted);
+    ASSERT_TRUE(first[2].Value == "w");
+    ASSERT_TRUE(first[2].Delim == cmListFileArgument::Bracket);
+    ASSERT_TRUE(second.size() == 1);
+
+    // The arguments of one invocation share a buffer that holds the text
+    // of that invocation only.
+    ASSERT_TRUE(shareBuffer(first));
+    ASSERT_TRUE(!inBuffer(second[0], first));
+    survivor = second[0];
+  }
+  ASSERT_TRUE(survivor.Value == "v");
+  ASSERT_TRUE(survivor.Line == 2);
+  return true;
+}
+
+int testListFileCache(int /*unused*/, char* /*unused*/ [])
+{
+  if (!testBuilder()) {
+    return 1;
+  }
+  if (!testParsedArguments()) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,156 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file Copyright.txt or https://cmake.org/licensing for details.  */
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cmPropertyMap.h"
+
+#define ASSERT_TRUE(x)                                                        \
+  do {                                                                        \
+    if (!(x)) {                                                               \
+      std::cout << "ASSERT_TRUE(" #x ") failed on line " << __LINE__ << "\n"; \
+      return false;                                                           \
+    }                                                                         \
+  } while (false)
+
+static bool isValue(cmProp value, char const* expected)
+{
+  return value && *value == expected;
+}
+
+static bool testSetGetRemove()
+{
+  std::cout << "testSetGetRemove()\n";
+  cmPropertyMap map;
+  ASSERT_TRUE(map.GetPropertyValue("testSetGetRemove_Unknown") == nullptr);
+
+  map.SetProperty("B", "b");
+  map.SetProperty("A", "a");
+  ASSERT_TRUE(isValue(map.GetPropertyValue("A"), "a"));
+  ASSERT_TRUE(isValue(map.GetPropertyValue("B"), "b"));
+  ASSERT_TRUE(map.GetPropertyValue("C") == nullptr);
+
+  map.SetProperty("A", "a2");
+  ASSERT_TRUE(isValue(map.GetPropertyValue("A"), "a2"));
+
+  map.SetProperty("A", nullptr);
+  ASSERT_TRUE(map.GetPropertyValue("A") == nullptr);
+  ASSERT_TRUE(isValue(map.GetPropertyValue("B"), "b"));
+
+  map.RemoveProperty("B");
+  map.RemoveProperty("testSetGetRemove_NeverSet");
+  ASSERT_TRUE(map.GetKeys().empty());
+
+  // Names interned by another map are not set in this one.
+  cmPropertyMap other;
+  other.SetProperty("testSetGetRemove_Other", "x");
+  ASSERT_TRUE(map.GetPropertyValue("testSetGetRemove_Other") == nullptr);
+  return true;
+}
+
+static bool testAppend()
+{
+  std::cout << "testAppend()\n";
+  cmPropertyMap map;
+  map.AppendProperty("L", "");
+  ASSERT_TRUE(map.GetPropertyValue("L") == nullptr);
+  map.AppendProperty("L", "a");
+  map.AppendProperty("L", "b");
+  ASSERT_TRUE(isValue(map.GetPropertyValue("L"), "a;b"));
+  map.AppendProperty("L", "c", true);
+  ASSERT_TRUE(isValue(map.GetPropertyValue("L"), "a;bc"));
+  return true;
+}
+
+static bool testStableValues()
+{
+  std::cout << "testStableValues()\n";
+  cmPropertyMap map;
+  map.SetProperty("M", "m");
+  cmProp m = map.GetPropertyValue("M");
+  for (int i = 0; i < 100; ++i) {
+    map.SetProperty("testStableValues_" + std::to_string(i), "v");
+  }
+  ASSERT_TRUE(m == map.GetPropertyValue("M"));
+  ASSERT_TRUE(isValue(m, "m"));
+  return true;
+}
+
+static bool testCopyAndLists()
+{
+  std::cout << "testCopyAndLists()\n";
+  cmPropertyMap map;
+  map.SetProperty("Z", "z");
+  map.SetProperty("Y", "y");
+  map.SetProperty("X", "x");
+
+  cmPropertyMap copy(map);
+  copy.SetProperty("X", "x2");
+  ASSERT_TRUE(isValue(map.GetPropertyValue("X"), "x"));
+  ASSERT_TRUE(isValue(copy.GetPropertyValue("X"), "x2"));
+
+  map = copy;
+  ASSERT_TRUE(isValue(map.GetPropertyValue("X"), "x2"));
+  ASSERT_TRUE(map.GetPropertyValue("X") != copy.GetPropertyValue("X"));
+
+  std::vector<std::string> keys = map.GetKeys();
+  ASSERT_TRUE((keys == std::vector<std::string>{ "X", "Y", "Z" }));
+
+  std::vector<std::pair<std::string, std::string>> list = map.GetList();
+  ASSERT_TRUE(list.size() == 3);
+  ASSERT_TRUE(list[0].first == "X" && list[0].second == "x2");
+  ASSERT_TRUE(list[2].first == "Z" && list[2].second == "z");
+
+  cmPropertyMap moved(std::move(copy));
+  ASSERT_TRUE(isValue(moved.GetPropertyValue("Y"), "y"));
+
+  map.Clear();
+  ASSERT_TRUE(map.GetKeys().empty());
+  return true;
+}
+
+static bool testManyNames()
+{
+  std::cout << "testManyNames()\n";
+  cmPropertyMap known;
+  known.SetProperty("KNOWN", "k");
+
+  // Intern enough new names to grow the shared name table several times.
+  cmPropertyMap map;
+  for (int i = 0; i < 5000; ++i) {
+    std::string const name = "MANY_" + std::to_string(i);
+    map.SetProperty(name, name.c_str());
+  }
+  ASSERT_TRUE(isValue(known.GetPropertyValue("KNOWN"), "k"));
+  ASSERT_TRUE(!known.GetPropertyValue("MANY_0"));
+
+  for (int i = 0; i < 5000; ++i) {
+    std::string const name = "MANY_" + std::to_string(i);
+    ASSERT_TRUE(isValue(map.GetPropertyValue(name), name.c_str()));
+  }
+  ASSERT_TRUE(map.GetKeys().size() == 5000);
+  return true;
+}
+
+int testPropertyMap(int /*unused*/, char* /*unused*/ [])
+{
+  if (!testSetGetRemove()) {
+    return 1;
+  }
+  if (!testAppend()) {
+    return 1;
+  }
+  if (!testStableValues()) {
+    return 1;
+  }
+  if (!testCopyAndLists()) {
+    return 1;
+  }
+  if (!testManyNames()) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,4 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/somelib.txt" _name)
+if(NOT _name STREQUAL "pre_renamed.changed\n")
+  set(RunCMake_TEST_FAILED "TARGET_FILE_NAME is not updated:\n  ${_name}")
+endif()
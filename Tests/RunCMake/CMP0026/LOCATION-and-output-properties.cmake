@@ -0,0 +1,22 @@
+enable_language(CXX)
+
+cmake_policy(SET CMP0026 OLD)
+
+add_library(somelib SHARED empty.cpp)
+
+# Ask for the location before the properties it is made of are final.
+get_target_property(_early somelib LOCATION)
+set_target_properties(somelib PROPERTIES
+  PREFIX "pre_"
+  OUTPUT_NAME "renamed"
+  SUFFIX ".changed"
+  )
+
+get_target_property(_late somelib LOCATION)
+get_filename_component(_late_name "${_late}" NAME)
+if(NOT _late_name STREQUAL "pre_renamed.changed")
+  message(SEND_ERROR "LOCATION is not updated:\n  ${_late}")
+endif()
+
+file(GENERATE OUTPUT "${CMAKE_CURRENT_BINARY_DIR}/somelib.txt"
+  CONTENT "$<TARGET_FILE_NAME:somelib>\n")
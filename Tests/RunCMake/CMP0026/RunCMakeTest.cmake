@@ -13,3 +13,4 @@ run_cmake(CMP0026-LOCATION-CONFIG-WARN)
 run_cmake(ObjlibNotDefined)
 run_cmake(LOCATION-and-TARGET_OBJECTS)
 run_cmake(clear-cached-information)
+run_cmake(LOCATION-and-output-properties)
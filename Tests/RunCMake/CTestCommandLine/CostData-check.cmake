@@ -0,0 +1,26 @@
+set(cost_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt")
+if(NOT EXISTS "${cost_file}")
+  set(RunCMake_TEST_FAILED "Cost data file not written:\n  ${cost_file}")
+  return()
+endif()
+file(STRINGS "${cost_file}" cost_lines)
+
+set(expect
+  "^CostKnown 3 [0-9.e+-]+ [0-9.e+-]+( [0-9]+)?$"
+  "^CostGone 3 1.5 0.25$"
+  "^CostNew 1 [0-9.e+-]+( [0-9.e+-]+ [0-9]+)?$"
+  )
+foreach(e IN LISTS expect)
+  set(found 0)
+  foreach(l IN LISTS cost_lines)
+    if(l MATCHES "${e}")
+      set(found 1)
+    endif()
+  endforeach()
+  if(NOT found)
+    string(REPLACE ";" "\n  " cost_lines "${cost_lines}")
+    set(RunCMake_TEST_FAILED
+      "Cost data does not match\n  ${e}\nActual:\n  ${cost_lines}")
+    return()
+  endif()
+endforeach()
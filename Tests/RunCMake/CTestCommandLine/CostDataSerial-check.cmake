@@ -0,0 +1,7 @@
+set(cost_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt")
+file(STRINGS "${cost_file}" cost_lines)
+# The mean of 100, 100 and a near zero run is close to 66.67.
+if(NOT cost_lines MATCHES "(^|;)CostKnown 3 66\\.[0-9]+ [0-9.e+-]+")
+  string(REPLACE ";" "\n  " cost_lines "${cost_lines}")
+  set(RunCMake_TEST_FAILED "Cost data does not match\nActual:\n  ${cost_lines}")
+endif()
@@ -0,0 +1,32 @@
+file(GLOB test_xml "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(NOT test_xml)
+  set(RunCMake_TEST_FAILED "Test.xml not written")
+  return()
+endif()
+file(READ "${test_xml}" xml)
+if(NOT xml MATCHES "name=\"Memory Budget\">[ \t\n]*<Value>4</Value>")
+  set(RunCMake_TEST_FAILED "Memory Budget not reported in Test.xml")
+  return()
+endif()
+
+set(cost_file "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt")
+file(STRINGS "${cost_file}" cost_lines)
+set(expect
+  "^MemBig 2 [0-9.e+-]+ [0-9.e+-]+ [0-9]+$"
+  "^MemSmall 2 [0-9.e+-]+ [0-9.e+-]+ [0-9]+$"
+  "^MemGone 3 1.5 0 1024$"
+  )
+foreach(e IN LISTS expect)
+  set(found 0)
+  foreach(l IN LISTS cost_lines)
+    if(l MATCHES "${e}")
+      set(found 1)
+    endif()
+  endforeach()
+  if(NOT found)
+    string(REPLACE ";" "\n  " cost_lines "${cost_lines}")
+    set(RunCMake_TEST_FAILED
+      "Cost data does not match\n  ${e}\nActual:\n  ${cost_lines}")
+    return()
+  endif()
+endforeach()
@@ -0,0 +1,27 @@
+string(JSON budget ERROR_VARIABLE err GET "${actual_stdout}" memoryBudget)
+if(err OR NOT budget MATCHES "^4(\\.0*)?$")
+  set(RunCMake_TEST_FAILED "memoryBudget is not 4:\n${actual_stdout}")
+  return()
+endif()
+
+# Reading the peak memory must not load the recorded cost.
+if(actual_stdout MATCHES "\"COST\"")
+  set(RunCMake_TEST_FAILED "COST reported from cost data:\n${actual_stdout}")
+  return()
+endif()
+
+foreach(i 0 1)
+  string(JSON name GET "${actual_stdout}" tests ${i} name)
+  string(JSON peak ERROR_VARIABLE err GET "${actual_stdout}"
+    tests ${i} peakMemory)
+  if(name STREQUAL "MemBig")
+    set(expect 3)
+  else()
+    set(expect 2)
+  endif()
+  if(err OR NOT peak MATCHES "^${expect}(\\.0*)?$")
+    set(RunCMake_TEST_FAILED
+      "peakMemory of ${name} is not ${expect}:\n${actual_stdout}")
+    return()
+  endif()
+endforeach()
@@ -0,0 +1,37 @@
+file(GLOB test_xml "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(NOT test_xml)
+  set(RunCMake_TEST_FAILED "Test.xml not written")
+  return()
+endif()
+file(READ "${test_xml}" xml)
+foreach(e
+    "line 0 of chatty"
+    "bytes of the test output were removed since it exceeds the threshold of 400 bytes"
+    "The complete output is in [^\n]*/Testing/Temporary/TestOutput-1\\.log\\.gz"
+    "line 1999 of chatty"
+    "line 0 of unclosed"
+    "line 1999 of unclosed"
+    "line 0 of full"
+    "line 999 of full"
+    "line 1999 of full"
+    )
+  if(NOT xml MATCHES "${e}")
+    set(RunCMake_TEST_FAILED "Test.xml output does not match\n  ${e}")
+    return()
+  endif()
+endforeach()
+foreach(name chatty unclosed)
+  if(xml MATCHES "line 999 of ${name}")
+    set(RunCMake_TEST_FAILED "Test.xml output of ${name} was not truncated")
+    return()
+  endif()
+endforeach()
+if(xml MATCHES "of full[^<]*bytes of the test output were removed")
+  set(RunCMake_TEST_FAILED "Test.xml output of full was truncated")
+  return()
+endif()
+
+set(spill "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/TestOutput-1.log.gz")
+if(NOT EXISTS "${spill}")
+  set(RunCMake_TEST_FAILED "Complete output not written:\n  ${spill}")
+endif()
@@ -224,6 +224,178 @@ run_TestLoad(test-load-pass 10)
 
 unset(ENV{__CTEST_FAKE_LOAD_AVERAGE_FOR_TESTING})
 
+function(run_CostData)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/CostData)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(CostKnown \"${CMAKE_COMMAND}\" -E echo \"test of cost data\")
+  add_test(CostNew \"${CMAKE_COMMAND}\" -E echo \"test of cost data\")
+")
+  # Seed the file in the older format without a variance column.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+    "CostKnown 2 100\nCostGone 3 1.5 0.25\n---\nCostGone\n")
+  run_cmake_command(CostData ${CMAKE_CTEST_COMMAND} -j2)
+endfunction()
+run_CostData()
+
+function(run_CostDataSerial)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/CostDataSerial)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(CostKnown \"${CMAKE_COMMAND}\" -E echo \"test of cost data\")
+")
+  # A serial run does not schedule by cost but must still update the
+  # recorded mean from the history rather than from zero.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+    "CostKnown 2 100\n---\n")
+  run_cmake_command(CostDataSerial ${CMAKE_CTEST_COMMAND} -j1)
+endfunction()
+run_CostDataSerial()
+
+function(run_ScheduleCriticalPath)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ScheduleCriticalPath)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(ShortGate \"${CMAKE_COMMAND}\" -E echo ShortGate)
+  add_test(ShortTail \"${CMAKE_COMMAND}\" -E echo ShortTail)
+  add_test(Long \"${CMAKE_COMMAND}\" -E echo Long)
+  set_tests_properties(ShortGate PROPERTIES COST 1)
+  set_tests_properties(ShortTail PROPERTIES COST 1 DEPENDS ShortGate)
+  set_tests_properties(Long PROPERTIES COST 6)
+")
+  run_cmake_command(ScheduleCriticalPath
+    ${CMAKE_CTEST_COMMAND} -j2 --schedule-critical-path)
+endfunction()
+run_ScheduleCriticalPath()
+
+function(run_MemoryBudget)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/MemoryBudget)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  # Each test fails if the other one started but has not finished yet.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/mem.cmake" "
+file(WRITE \${name}.start \"\")
+execute_process(COMMAND \"\${CMAKE_COMMAND}\" -E sleep 1)
+if(EXISTS \${other}.start AND NOT EXISTS \${other}.end)
+  message(FATAL_ERROR \"\${name} overlapped \${other}\")
+endif()
+file(WRITE \${name}.end \"\")
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(MemBig \"${CMAKE_COMMAND}\"
+    -Dname=MemBig -Dother=MemSmall -P mem.cmake)
+  add_test(MemSmall \"${CMAKE_COMMAND}\"
+    -Dname=MemSmall -Dother=MemBig -P mem.cmake)
+")
+  # Seed peaks in KiB that do not fit the budget together.
+  set(cost_data
+    "MemBig 1 0.5 0 3072\nMemSmall 1 0.5 0 2048\nMemGone 3 1.5 0 1024\n---\n")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+    "${cost_data}")
+  run_cmake_command(MemoryBudget-json
+    ${CMAKE_CTEST_COMMAND} -j2 --show-only=json-v1 --test-memory-budget 4)
+  run_cmake_command(MemoryBudget
+    ${CMAKE_CTEST_COMMAND} -j2 --test-memory-budget 4 -T Test)
+
+  # Without a budget that holds them apart the two tests do overlap.
+  file(REMOVE "${RunCMake_TEST_BINARY_DIR}/MemBig.start"
+    "${RunCMake_TEST_BINARY_DIR}/MemBig.end"
+    "${RunCMake_TEST_BINARY_DIR}/MemSmall.start"
+    "${RunCMake_TEST_BINARY_DIR}/MemSmall.end")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary/CTestCostData.txt"
+    "${cost_data}")
+  run_cmake_command(MemoryBudget-overlap
+    ${CMAKE_CTEST_COMMAND} -j2 --test-memory-budget 8)
+endfunction()
+run_MemoryBudget()
+
+function(run_OutputStreaming)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/OutputStreaming)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/chatty.cmake" "
+foreach(i RANGE 1999)
+  message(\"line \${i} of chatty\")
+endforeach()
+")
+  # A measurement that is never closed must not be kept in memory whole.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/unclosed.cmake" "
+message(\"<DartMeasurement name=\\\"Open\\\" type=\\\"text/string\\\">\")
+foreach(i RANGE 1999)
+  message(\"line \${i} of unclosed\")
+endforeach()
+")
+  # Asking for the full output late must still report all of it.
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/full.cmake" "
+foreach(i RANGE 1999)
+  message(\"line \${i} of full\")
+  if(i EQUAL 1500)
+    message(\"CTEST_FULL_OUTPUT\")
+  endif()
+endforeach()
+")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(Chatty \"${CMAKE_COMMAND}\" -P chatty.cmake)
+  set_tests_properties(Chatty PROPERTIES
+    PASS_REGULAR_EXPRESSION \"line 1000 of chatty\")
+  add_test(Unclosed \"${CMAKE_COMMAND}\" -P unclosed.cmake)
+  add_test(Full \"${CMAKE_COMMAND}\" -P full.cmake)
+")
+  run_cmake_command(OutputStreaming ${CMAKE_CTEST_COMMAND}
+    -T Test --no-compress-output --test-output-streaming
+    --test-output-size-passed 400 --test-output-size-failed 400)
+endfunction()
+run_OutputStreaming()
+
+function(run_Shards)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Shards)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+  add_test(Heavy \"${CMAKE_COMMAND}\" -E echo Heavy)
+  add_test(Chain1 \"${CMAKE_COMMAND}\" -E echo Chain1)
+  add_test(Chain2 \"${CMAKE_COMMAND}\" -E echo Chain2)
+  add_test(Light1 \"${CMAKE_COMMAND}\" -E echo Light1)
+  add_test(Light2 \"${CMAKE_COMMAND}\" -E echo Light2)
+  set_tests_properties(Heavy PROPERTIES COST 5)
+  set_tests_properties(Chain1 PROPERTIES COST 2)
+  set_tests_properties(Chain2 PROPERTIES COST 2 DEPENDS Chain1)
+")
+  # The cost data of the build tree would move Light1 to the first shard,
+  # but it changes with every run and must not affect the split.
+  set(shard_dir "${RunCMake_TEST_BINARY_DIR}/Testing/Temporary")
+  file(WRITE "${shard_dir}/CTestCostData.txt" "Light1 1 100 0\n---\n")
+  file(COPY "${shard_dir}/CTestCostData.txt"
+    DESTINATION "${RunCMake_TEST_BINARY_DIR}/frozen")
+  run_cmake_command(Shards-1 ${CMAKE_CTEST_COMMAND} --shard 1/2)
+  run_cmake_command(Shards-2 ${CMAKE_CTEST_COMMAND} --shard 2/2)
+  run_cmake_command(Shards-merge ${CMAKE_CTEST_COMMAND}
+    -M Experimental -T Test --merge-shards
+    "${shard_dir}/CTestShard-1-of-2.json\;${shard_dir}/CTestShard-2-of-2.json")
+  run_cmake_command(Shards-merge-missing ${CMAKE_CTEST_COMMAND}
+    --merge-shards "${shard_dir}/CTestShard-1-of-2.json")
+  # Claim the results of the first shard for the second one too.
+  file(READ "${shard_dir}/CTestShard-1-of-2.json" shard_json)
+  string(REPLACE "\"shard\":1," "\"shard\":2," shard_json "${shard_json}")
+  file(WRITE "${shard_dir}/CTestShard-dup.json" "${shard_json}")
+  run_cmake_command(Shards-merge-duplicate ${CMAKE_CTEST_COMMAND}
+    --merge-shards
+    "${shard_dir}/CTestShard-1-of-2.json\;${shard_dir}/CTestShard-dup.json")
+  run_cmake_command(Shards-frozen ${CMAKE_CTEST_COMMAND} --shard 1/2
+    --shard-cost-data "${RunCMake_TEST_BINARY_DIR}/frozen/CTestCostData.txt")
+  run_cmake_command(Shards-bad ${CMAKE_CTEST_COMMAND} --shard 3/2)
+endfunction()
+run_Shards()
+
 function(run_TestOutputSize)
   set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/TestOutputSize)
   set(RunCMake_TEST_NO_CLEAN 1)
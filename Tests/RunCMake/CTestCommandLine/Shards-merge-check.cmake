@@ -0,0 +1,13 @@
+file(GLOB test_xml_file "${RunCMake_TEST_BINARY_DIR}/Testing/*/Test.xml")
+if(test_xml_file)
+  file(READ "${test_xml_file}" test_xml)
+  set(names "")
+  string(REGEX MATCHALL "<Name>[A-Za-z0-9]+</Name>" names "${test_xml}")
+  string(REPLACE "<Name>" "" names "${names}")
+  string(REPLACE "</Name>" "" names "${names}")
+  if(NOT names STREQUAL "Heavy;Chain1;Chain2;Light1;Light2")
+    set(RunCMake_TEST_FAILED "Test.xml does not list the tests of both shards in order:\n ${names}")
+  endif()
+else()
+  set(RunCMake_TEST_FAILED "Test.xml not found")
+endif()
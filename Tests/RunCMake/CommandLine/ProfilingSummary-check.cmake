@@ -0,0 +1,33 @@
+if (NOT EXISTS ${ProfilingTestOutput})
+  set(RunCMake_TEST_FAILED "Expected ${ProfilingTestOutput} to exists")
+  return()
+endif()
+
+file(STRINGS ${ProfilingTestOutput} header LIMIT_COUNT 1)
+if (NOT header STREQUAL "CMake profiling summary")
+  set(RunCMake_TEST_FAILED "Expected summary header, got:\n ${header}")
+  return()
+endif()
+
+foreach(table "Commands" "Functions and macros" "List files" "Include chains"
+              "Generate steps")
+  file(STRINGS ${ProfilingTestOutput} title REGEX "^${table} \\([0-9]+\\)$")
+  if (NOT title)
+    set(RunCMake_TEST_FAILED "Expected table \"${table}\"")
+    return()
+  endif()
+endforeach()
+
+file(STRINGS ${ProfilingTestOutput} functionRows
+  REGEX "^ +[0-9.]+ +[0-9.]+ +2 +[0-9]+  __testing_summary_function$")
+list(LENGTH functionRows numRows)
+if (NOT numRows EQUAL 2)
+  set(RunCMake_TEST_FAILED
+      "Expected a command and a function row with two calls, got:\n ${functionRows}")
+endif()
+
+file(STRINGS ${ProfilingTestOutput} computeRow
+  REGEX "^ +[0-9.]+ +[0-9.]+ +1 +[0-9]+  generate: Compute$")
+if (NOT computeRow)
+  set(RunCMake_TEST_FAILED "Expected a row for the Compute step")
+endif()
@@ -0,0 +1,6 @@
+function(__testing_summary_function)
+  set(var "${CMAKE_CURRENT_LIST_FILE}")
+endfunction()
+
+__TESTING_SUMMARY_FUNCTION()
+__testing_summary_function()
@@ -29,3 +29,9 @@ if (NOT numInvocations EQUAL 1)
   set(RunCMake_TEST_FAILED
       "Unexpected number of lowercase command names: ${numInvocations}")
 endif()
+
+file(STRINGS ${ProfilingTestOutput} computeEntry
+  REGEX [["cat"[ ]*:[ ]*"generate"]])
+if (NOT computeEntry)
+  set(RunCMake_TEST_FAILED "Generate steps not found in profiling output")
+endif()
@@ -0,0 +1,14 @@
+set(cache "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/ListFileParseCache.bin")
+if(NOT EXISTS "${cache}")
+  set(RunCMake_TEST_FAILED "Parse cache was not written:\n  ${cache}")
+  return()
+endif()
+file(STRINGS "${cache}" strings)
+string(FIND "${strings}" "ListFileParseCacheModule.cmake" module_pos)
+set(generated "${RunCMake_TEST_BINARY_DIR}/ListFileParseCacheGenerated.cmake")
+string(FIND "${strings}" "${generated}" generated_pos)
+if(module_pos EQUAL -1)
+  set(RunCMake_TEST_FAILED "Parse cache does not contain the included module.")
+elseif(NOT generated_pos EQUAL -1)
+  set(RunCMake_TEST_FAILED "Parse cache contains a file modified during configure.")
+endif()
@@ -0,0 +1,10 @@
+include(${CMAKE_CURRENT_LIST_DIR}/ListFileParseCacheModule.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/ListFileParseCacheModule.cmake)
+
+# A file rewritten with the same size right after it was read must not be
+# taken from the cache.
+set(generated "${CMAKE_CURRENT_BINARY_DIR}/ListFileParseCacheGenerated.cmake")
+file(WRITE "${generated}" "message(STATUS \"Generated 1\")\n")
+include("${generated}")
+file(WRITE "${generated}" "message(STATUS \"Generated 2\")\n")
+include("${generated}")
@@ -0,0 +1 @@
+message(STATUS "ListFileParseCacheModule included")
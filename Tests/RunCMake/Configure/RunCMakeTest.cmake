@@ -51,6 +51,18 @@ run_cmake(RemoveCache)
 file(REMOVE "${RunCMake_TEST_BINARY_DIR}/CMakeCache.txt")
 run_cmake(RemoveCache)
 
+# Configure twice so the second run loads the parse cache of the first.
+set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ListFileParseCache-build)
+set(RunCMake_TEST_NO_CLEAN 1)
+set(RunCMake_TEST_OPTIONS -DCMAKE_LIST_FILE_PARSE_CACHE=ON)
+file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+run_cmake(ListFileParseCache)
+run_cmake(ListFileParseCache)
+unset(RunCMake_TEST_OPTIONS)
+unset(RunCMake_TEST_BINARY_DIR)
+unset(RunCMake_TEST_NO_CLEAN)
+
 if(NOT RunCMake_GENERATOR MATCHES "^Ninja Multi-Config$")
   run_cmake(NoCMAKE_CROSS_CONFIGS)
   run_cmake(NoCMAKE_DEFAULT_BUILD_TYPE)
@@ -0,0 +1,9 @@
+set(state "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/VerifyGlobs.state")
+if(NOT EXISTS "${state}")
+  set(RunCMake_TEST_FAILED "Glob verification state not written:\n  ${state}")
+  return()
+endif()
+file(READ "${state}" content)
+if(NOT content MATCHES "\n[0-9a-f]+ [1-9][0-9]*\n")
+  set(RunCMake_TEST_FAILED "Glob directories not recorded in\n  ${state}\nwhich contains:\n${content}")
+endif()
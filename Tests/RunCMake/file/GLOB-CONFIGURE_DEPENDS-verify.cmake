@@ -0,0 +1,11 @@
+set(tree "${CMAKE_CURRENT_BINARY_DIR}/tree")
+if(CASE STREQUAL "GLOB")
+  file(GLOB files CONFIGURE_DEPENDS "${tree}/*.txt")
+elseif(CASE STREQUAL "GLOB-LIST_DIRECTORIES-false")
+  file(GLOB files CONFIGURE_DEPENDS LIST_DIRECTORIES false "${tree}/*")
+elseif(CASE STREQUAL "GLOB_RECURSE")
+  file(GLOB_RECURSE files CONFIGURE_DEPENDS "${tree}/*.txt")
+elseif(CASE STREQUAL "GLOB_RECURSE-LIST_DIRECTORIES-true")
+  file(GLOB_RECURSE files CONFIGURE_DEPENDS LIST_DIRECTORIES true
+    RELATIVE "${tree}" "${tree}/*.txt")
+endif()
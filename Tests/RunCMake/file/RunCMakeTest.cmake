@@ -156,3 +156,63 @@ else()
   unset(RunCMake_TEST_NO_CLEAN)
   unset(RunCMake_DEFAULT_stderr)
 endif()
+
+# Run the glob verification of CONFIGURE_DEPENDS directly.  Each case is
+# checked first against directories recorded by a previous verification,
+# and then after a reconfiguration, when the directories are too recent
+# to be recorded.
+function(run_GLOB_verify case remove neutral add)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/GLOB-CONFIGURE_DEPENDS-verify-${case}-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  set(RunCMake_TEST_OPTIONS -DCASE=${case})
+  set(tree "${RunCMake_TEST_BINARY_DIR}/tree")
+  set(verify ${CMAKE_COMMAND} -E cmake_verify_globs CMakeFiles/VerifyGlobs.json)
+
+  run_cmake(GLOB-CONFIGURE_DEPENDS-verify)
+  set(RunCMake-check-file GLOB-CONFIGURE_DEPENDS-verify-recorded-check.cmake)
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-${case}-unchanged ${verify})
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-${case}-unchanged-recorded ${verify})
+  unset(RunCMake-check-file)
+
+  file(REMOVE_RECURSE "${tree}/${remove}")
+  set(RunCMake_DEFAULT_stderr "^-- GLOB mismatch!$")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-${case}-removed ${verify})
+  unset(RunCMake_DEFAULT_stderr)
+
+  run_cmake(GLOB-CONFIGURE_DEPENDS-verify)
+  if(neutral MATCHES "/$")
+    file(MAKE_DIRECTORY "${tree}/${neutral}")
+  else()
+    file(WRITE "${tree}/${neutral}" "")
+  endif()
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-${case}-unrelated ${verify})
+
+  if(add MATCHES "/$")
+    file(MAKE_DIRECTORY "${tree}/${add}")
+  else()
+    file(WRITE "${tree}/${add}" "")
+  endif()
+  set(RunCMake_DEFAULT_stderr "^-- GLOB mismatch!$")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-verify-${case}-added ${verify})
+endfunction()
+
+set(GLOB_verify_cases
+  # case remove unrelated added
+  "GLOB\;a.txt\;f.dat\;e.txt"
+  "GLOB-LIST_DIRECTORIES-false\;b.dat\;newdir/\;g"
+  "GLOB_RECURSE\;sub/deep/d.txt\;sub/x/\;sub/new.txt"
+  "GLOB_RECURSE-LIST_DIRECTORIES-true\;sub/c.txt\;sub/deep/n.dat\;sub/x/"
+  )
+foreach(case IN LISTS GLOB_verify_cases)
+  list(GET case 0 name)
+  set(build ${RunCMake_BINARY_DIR}/GLOB-CONFIGURE_DEPENDS-verify-${name}-build)
+  file(REMOVE_RECURSE "${build}")
+  foreach(f a.txt b.dat sub/c.txt sub/deep/d.txt)
+    file(WRITE "${build}/tree/${f}" "")
+  endforeach()
+endforeach()
+# Let the directories age enough to be recorded.
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 3)
+foreach(case IN LISTS GLOB_verify_cases)
+  run_GLOB_verify(${case})
+endforeach()